@@ -22,10 +22,20 @@ mv SDL2_ttf-tmp/x86_64-w64-mingw32 SDL2_ttf
 rm -Rf SDL2_ttf-tmp
 cp ../resources/SDL_ttf.h SDL2_ttf/include/SDL2
 
-# compile game
+# compile game, optimized w/ link time optimization unless built w/ ./build.sh debug
+FLAGS=(-O3 -flto)
+[[ "$1" == debug ]] && FLAGS=(-ggdb3 -O0)
 cd ../../
 mkdir ../bin ../obj
 cp ../resources/FreeMonoBold.ttf ../bin
-gcc -o ../obj/engine.o -c ../src/engine.c -ISDL-install/include -ISDL2_ttf/include -D_THREAD_SAFE
-gcc -o ../obj/rendering.o -c ../src/rendering.c -ISDL-install/include -ISDL2_ttf/include -D_THREAD_SAFE
-gcc -o ../bin/battleship ../src/battleship.c ../obj/engine.o ../obj/rendering.o -ISDL-install/include -ISDL2_ttf/include -D_THREAD_SAFE -LSDL-install/lib -lSDL2_ttf/lib -lSDL2 -lSDL2_ttf
+gcc $FLAGS -o ../obj/cellmap.o -c ../src/cellmap.c
+gcc $FLAGS -o ../obj/pool.o -c ../src/pool.c
+gcc $FLAGS -o ../obj/rules.o -c ../src/rules.c
+gcc $FLAGS -o ../obj/engine.o -c ../src/engine.c
+gcc $FLAGS -o ../obj/opponent.o -c ../src/opponent.c
+gcc $FLAGS -o ../obj/strategy.o -c ../src/strategy.c
+gcc $FLAGS -o ../obj/game.o -c ../src/game.c
+gcc $FLAGS -o ../obj/network.o -c ../src/network.c
+gcc $FLAGS -o ../obj/timer.o -c ../src/timer.c
+gcc $FLAGS -o ../obj/rendering.o -c ../src/rendering.c -ISDL-install/include -ISDL2_ttf/include -D_THREAD_SAFE
+gcc $FLAGS -o ../bin/battleship ../src/battleship.c ../obj/cellmap.o ../obj/pool.o ../obj/rules.o ../obj/engine.o ../obj/opponent.o ../obj/strategy.o ../obj/game.o ../obj/network.o ../obj/timer.o ../obj/rendering.o -ISDL-install/include -ISDL2_ttf/include -D_THREAD_SAFE -LSDL-install/lib -lSDL2_ttf/lib -lSDL2 -lSDL2_ttf
@@ -30,289 +30,78 @@ In this game, you will play against the computer to see who can sink all of each
     Your computer opponent's board will also be revealed at the end of the game.
 */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include "engine.h"
+#include "game.h"
+#include "network.h"
 #include "rendering.h"
+#include "timer.h"
 
-// stores data about computer player's guess
-typedef struct
-{
-    int initX, initY;
-    int offset1, offset2;
-    int rot;
-} opponentGuess;
-
-/* Initialization
-**********************************************************************
-*********************************************************************/
-
-// zero out grids
-void initializeBoards(player *p)
-{
-    for (int i = 0; i < BOARD_SIZE_X; i++)
-    {
-        for (int j = 0; j < BOARD_SIZE_Y; j++)
-        {
-            p->grid[i][j] = 0;
-        }
-    }
-}
-
-// set default values and positions for player's ships
-void initializeShips(player *p)
-{
-    ship s;
-    int x, y;
-
-    // initialize ships array w/ empty ship structs
-    for (int i = 0; i < NSHIPS; i++)
-        p->ships[i] = s;
-
-    // set ship lengths
-    p->ships[0].len = 5; // carrier
-    p->ships[1].len = 4; // cruiser
-    p->ships[2].len = 3; // destroyer
-    p->ships[3].len = 3; // submarine
-    p->ships[4].len = 2; // patrol boat
-
-    for (int i = 0; i < NSHIPS; i++)
-    {
-        p->ships[i].rot = 0;                      // initial orientation left
-        p->ships[i].isPlaced = false;             // ships not placed on board yet
-        p->ships[i].sunk = false;                 // no ships sunk yet
-        p->ships[i].center = p->ships[i].len / 2; // calculate ship's center point
-
-        // set rectangle dimensions for copying number texture
-        p->ships[i].numberRect.w = 13;
-        p->ships[i].numberRect.h = 25;
-
-        // place ships to right of player board
-        for (int j = 0; j < p->ships[i].len; j++)
-        {
-            x = 13 + j;
-            y = i * 2 + 7;
-            p->grid[x][y] = 1;
-            p->ships[i].pos[j] = &p->grid[x][y];
-        }
-
-        p->ships[i].initCenterPos = p->ships[i].pos[p->ships[i].center]; // initial position of ship's center
-    }
+#define PAUSE_TIME 0.99 // seconds a message pauses the game for
 
-    p->selectedShip = -1; // no ship selected yet
-}
-
-// set opponentGuess struct to default values
-void resetOpGuess(opponentGuess *opGuess)
-{
-    opGuess->initX = 0;
-    opGuess->initY = 0;
-    opGuess->offset1 = 0;
-    opGuess->offset2 = 0;
-    opGuess->rot = -1;
-}
-
-// place opponent's ships at random locations w/ random rotations
-void initializeOpponent(player *p, opponentGuess *opGuess)
+// window state outside of game rules, changed by timers
+typedef struct
 {
-    ship *s;
-    int x, y;
-
-    for (int i = 0; i < NSHIPS; i++)
-    {
-        p->selectedShip = i;
-        s = &p->ships[p->selectedShip];
-        s->rot = rand() % 4; // randomize rotation
-        do
-        {
-            // randomize position
-            x = (rand() % 10) + 1;
-            y = (rand() % 10) + 1;
-
-            if (checkCells(p, &x, &y, NULL, 1)) // check that position on board is clear
-            {
-                // place ships and set grid values
-                placeSelectedShip(p, x, y);
-                placeShips(p);
-            }
-        } while (!s->isPlaced);
-    }
-    p->selectedShip = -1;
-
-    resetOpGuess(opGuess);
-}
-
-/*********************************************************************
-*********************************************************************/
+    game *g;
+    scheduler timers;
+    player *shown;  // player whose board is displayed
+    int pauseTimer; // timer ending current pause, -1 if none
+    bool ending;    // end of game msgs are being shown
+    bool quit;      // close window
+} ui;
 
 /* Game Logic
 **********************************************************************
 *********************************************************************/
 
-// start game if all ships are placed on board
-int startGame(player *p, bool *started)
-{
-    *started = true;
-    for (int i = 0; i < NSHIPS; i++)
-    {
-        // check if ship is placed
-        if (!p->ships[i].isPlaced)
-        {
-            *started = false;
-            p->msg = 1; // place all ships to start game msg
-            p->pause = true;
-            return 1;
-        }
-    }
-    p->selectedShip = -1; // ships cannot be selected after game has started
-    p->msg = 0;           // game started msg
-    return 0;
-}
-
-/* computer player's shooting logic
-    select random cell
-    hit or miss
-    if hit
-        random cell in 1 of 4 possible directions
-        if hit, gusss in cells either direction along line
-        if miss, select new direction
-    if miss
-        new random cell
-    keep track of last hit until ship has sank, then reset
-*/
-void opponentShot(player *p1, player *p2, bool *running, opponentGuess *opGuess)
+// perform actions corresponding to user input
+// net is session w/ other player of a network game, NULL when playing the computer
+void handleInput(game *g, SDL_Event *event, netSession *net)
 {
-    int x, y, rot, offset, action, i = 0;
-
-    // check if computer player previously had a hit
-    if (opGuess->initX != 0 && opGuess->initY != 0)
-    {
-        do
-        {
-            // get initial hit
-            x = opGuess->initX;
-            y = opGuess->initY;
-
-            // determine direction (left/right or up/down) of shot
-            // offset1- initial direction, offset2- opposite direction of offset1
-            offset = (opGuess->offset2 > 0) ? opGuess->offset2 * -1 : opGuess->offset1 + 1;
-
-            // determine ship's rotation and add offset to get shot position
-            if (opGuess->rot == -1)
-                opGuess->rot = rand() % 4; // assign random rotation if unknown
-            rot = opGuess->rot;
-            switch (opGuess->rot)
-            {
-            case 0:
-                x = opGuess->initX - offset;
-                break;
-            case 1:
-                y = opGuess->initY - offset;
-                break;
-            case 2:
-                x = opGuess->initX + offset;
-                break;
-            case 3:
-                y = opGuess->initY + offset;
-                break;
-            }
-
-            action = takeShot(p2, p1, running, x, y);
-
-            switch (action)
-            {
-            case 2:
-
-                // continue guessing in current direction if shot is a hit
-                if (opGuess->offset2 > 0)
-                    opGuess->offset2 += 1;
-                else
-                    opGuess->offset1 += 1;
-
-                break;
-            case 3:
-
-                // next shot is random if ship is sunk
-                resetOpGuess(opGuess);
-
-                break;
-            default:
-
-                // incremenet if shot following initial is a miss
-                if (opGuess->offset1 == 0)
-                {
-                    opGuess->rot = (opGuess->rot + 1) % 4;
-
-                    // guess in opposite direction if shots in each direction have already been taken and/or are misses
-                    if (opGuess->rot == rot)
-                        opGuess->offset2 = 1;
-                }
-
-                else
-                    opGuess->offset2 = 1; // guess in opposite direction
-                break;
-            }
-            i++;
-        } while (action == 0 && i < 4);
-
-        if (i >= 4)
-        {
-            // take random guess if more than four consecutive computer player's shot have already been taken
-            resetOpGuess(opGuess);
-            opponentShot(p1, p2, running, opGuess);
-        }
-    }
+    player *p1 = &g->players[0], *p2 = &g->players[1];
+    int x, y, action;
 
-    // take random shot if computer player did not have previous hit
-    else
+    // window events and quitting are handled even while paused
+    switch (event->type)
     {
-        do
-        {
-            x = (rand() % 10) + 1;
-            y = (rand() % 10) + 12;
-            action = takeShot(p2, p1, running, x, y);
-        } while (action == 0);
-        if (action == 2)
-        {
-            // keep track of position if shot is a hit
-            opGuess->initX = x;
-            opGuess->initY = y;
-        }
+    case SDL_QUIT:
+        g->running = false;
+        return;
+
+    // window contents may be lost when it's covered, resized or restored
+    // either board may be the one shown, so both are redrawn
+    case SDL_WINDOWEVENT:
+        p1->dirty = true;
+        p2->dirty = true;
+        return;
     }
-}
 
-// perform actions corresponding to user input
-void handleInput(bool *running, bool *started, int *turn, player *p1, player *p2)
-{
-    SDL_Event event = getInput();
-    int x, y, action;
-
-    if (!p1->pause)
-        switch (event.type)
+    // player can only act on their own turn while game is running
+    if (!p1->pause && g->running && g->turn % 2 == 0)
+        switch (event->type)
         {
-        case SDL_QUIT:
-            *running = false;
-            break;
-
         // keyboard input
         case SDL_KEYDOWN:
-            switch (event.key.keysym.scancode)
+            switch (event->key.keysym.scancode)
             {
 
             // select ships 1 - 5 w/ num keys
             case SDL_SCANCODE_1:
-                setSelectedShip(*started, p1, 0);
+                setSelectedShip(g->started, p1, 0);
                 break;
             case SDL_SCANCODE_2:
-                setSelectedShip(*started, p1, 1);
+                setSelectedShip(g->started, p1, 1);
                 break;
             case SDL_SCANCODE_3:
-                setSelectedShip(*started, p1, 2);
+                setSelectedShip(g->started, p1, 2);
                 break;
             case SDL_SCANCODE_4:
-                setSelectedShip(*started, p1, 3);
+                setSelectedShip(g->started, p1, 3);
                 break;
             case SDL_SCANCODE_5:
-                setSelectedShip(*started, p1, 4);
+                setSelectedShip(g->started, p1, 4);
                 break;
 
             // rotate ships left or right w/ arrow keys
@@ -325,7 +114,7 @@ void handleInput(bool *running, bool *started, int *turn, player *p1, player *p2
 
             // start game by pressing s
             case SDL_SCANCODE_S:
-                startGame(p1, started);
+                startGame(p1, &g->started);
                 break;
 
             default:
@@ -337,15 +126,22 @@ void handleInput(bool *running, bool *started, int *turn, player *p1, player *p2
         case SDL_MOUSEBUTTONDOWN:
 
             // get position of mouse on grid
-            x = event.motion.x / CELL_SIZE;
-            y = event.motion.y / CELL_SIZE;
+            x = event->button.x / CELL_SIZE;
+            y = event->button.y / CELL_SIZE;
 
             // take shot at position of mouse click if game has started
-            if (*started)
+            // network shots must be in bottom guessing grid too, host resolves them
+            if (g->started && net != NULL)
             {
-                action = takeShot(p1, p2, running, x, y);
+                if (x < 11 && x > 0 && y < 22 && y > 11)
+                    sendShot(net, g, x, y - 11);
+                break;
+            }
+            if (g->started)
+            {
+                action = takeShot(p1, p2, &g->running, x, y);
                 if (action != 0)
-                    *turn += 1;
+                    g->turn += 1;
                 break;
             }
 
@@ -358,33 +154,35 @@ void handleInput(bool *running, bool *started, int *turn, player *p1, player *p2
         }
 }
 
-// perform game logic
-int updateGame(bool *running, bool *started, int *turn, player *p1, player *p2, opponentGuess *opGuess)
+// perform game logic, one fixed step of game time
+int updateGame(game *g, netSession *net)
 {
-    // computer plays on odd turn number
-    if (*turn % 2 == 1)
+    player *p1 = &g->players[0], *p2 = &g->players[1];
+
+    // computer plays on odd turn number, network opponent's shots arrive through pollSession()
+    if (g->turn % 2 == 1 && net == NULL)
     {
         if (!p1->pause)
         {
-            opponentShot(p1, p2, running, opGuess);
-            *turn += 1;
+            strategyShot(g->strategies[1], p1, p2, &g->running, &g->guesses[1]);
+            g->turn += 1;
             p2->pause = false;
             return 0;
         }
     }
 
-    // player plays on even turn number
-    handleInput(running, started, turn, p1, p2);
-    if (*started)
+    // fleet is sent or committed to once placed, and once host's opponent has joined
+    if (g->started && net != NULL && !net->localReady && net->state == NET_PLACING)
+        commitFleet(net, g);
+
+    // player plays on even turn number, see handleInput()
+    if (g->started)
     {
-        if (*turn != 0 && !p1->pause)
-            p1->msg = 10; // your turn msg
+        if (g->turn != 0 && !p1->pause)
+            setMessage(p1, 10); // your turn msg
     }
     else
-    {
-        p1->msg = (p1->pause) ? p1->msg : 12; // place your ships msg
-        placeShips(p1);                       // place player's ships on grid if game has not started
-    }
+        setMessage(p1, (p1->pause) ? p1->msg : 12); // place your ships msg
     return 0;
 }
 
@@ -625,80 +423,232 @@ void displayInstructions()
         0x74, 0x20, 0x6f, 0x66, 0x20, 0x6c, 0x75, 0x63, 0x6b, 0x21, 0x00};
 
     printf("%s\n", resources_instructions_txt);
-    SDL_Delay(3000);
 }
 /*********************************************************************
 *********************************************************************/
 
-int main()
+/* Timed States
+**********************************************************************
+*********************************************************************/
+
+// let game continue after a message
+void endPause(void *data)
 {
-    SDL_Window *window = NULL;
-    player p1, p2; // player is p1 and computer/opponent is p2
-    opponentGuess opGuess;
-    clock_t start, end;
-    double sleepTime;
-    int turn = 0, i = 0;
-    bool running = true, started = false;
+    ui *u = data;
 
-    srand(time(NULL)); // initialize random psuedo-random seed for random actions
+    u->g->players[0].pause = false;
+    u->g->players[0].dirty = true;
+    u->pauseTimer = -1;
+}
+
+void showGameOver(void *data)
+{
+    ui *u = data;
+
+    setMessage(&u->g->players[0], 8); // game over msg
+}
+
+void showWinner(void *data)
+{
+    ui *u = data;
+
+    setMessage(&u->g->players[0], (checkGameOver(&u->g->players[1])) ? 16 : 17); // win or lose msg
+}
+
+// reveal computer player's board at end of game
+void revealBoard(void *data)
+{
+    ui *u = data;
+
+    setMessage(&u->g->players[1], 13); // opponent's board msg
+    u->shown = &u->g->players[1];
+}
+
+void closeWindow(void *data)
+{
+    ui *u = data;
+
+    u->quit = true;
+}
+
+// schedule timed states that follow changes in game
+void scheduleStates(ui *u)
+{
+    player *p1 = &u->g->players[0];
+
+    // pause updating game state while message is read
+    if (p1->pause && u->pauseTimer == -1)
+        u->pauseTimer = scheduleTimer(&u->timers, PAUSE_TIME, endPause, u);
+
+    // display end of game msgs, then opponent's board
+    if (!u->g->running && !u->ending)
+    {
+        u->ending = true;
+        scheduleTimer(&u->timers, 1, showGameOver, u);
+        scheduleTimer(&u->timers, 2, showWinner, u);
+        scheduleTimer(&u->timers, 5, revealBoard, u);
+        scheduleTimer(&u->timers, 10, closeWindow, u);
+    }
+}
+
+/*********************************************************************
+*********************************************************************/
+
+int main(int argc, char *argv[])
+{
+    SDL_Window *window = NULL;
+    renderCache cache;
+    game g; // player is players[0] and computer/opponent is players[1]
+    player *p1 = &g.players[0];
+    ui u = {&g};
+    netSession *net = NULL; // session w/ other player of a network game
+    bool host = argc > 1 && !strcmp(argv[1], "host"), join = argc > 1 && !strcmp(argv[1], "join");
+    int port = NET_PORT;
+    double timeout;
+    inputQueue input;
+    SDL_Event event;
+    double previous, current, lag = 0;
+    bool busy;
+    int updates;
 
     // display instructions before rendering window and beginning game
     displayInstructions();
 
     // initialize game elements
-    initializeBoards(&p1);
-    initializeBoards(&p2);
-    initializeShips(&p1);
-    initializeShips(&p2);
-    initializeOpponent(&p2, &opGuess);
-    p1.pause = false;
-    p2.pause = false;
+    initializeGameStorage(&g, NULL, 0);
+    if (initializeGame(&g, &standardRules))
+        return 1;
+    if (host || join)
+    {
+        // play another player over the network: host [port] or join address [port]
+        if (argc > 2 + join)
+            port = atoi(argv[2 + join]);
+        net = malloc(sizeof(netSession));
+        if (net == NULL || (join && argc < 3) || port < 1)
+        {
+            printf("Usage: %s host [port]\n       %s join address [port]\n", argv[0], argv[0]);
+            return 1;
+        }
+        if (host ? hostSession(net, port, true) : joinSession(net, argv[2], port, true))
+        {
+            printf("Can't %s port %d\n", host ? "listen on" : "connect to opponent on", port);
+            return 1;
+        }
+        if (host)
+            printf("Waiting for opponent on port %d\n", port);
+        seedGame(&g, (uint64_t)time(NULL));
+        initializeScheduler(&u.timers, 1);
+    }
+    else
+    {
+        // seed computer's random actions, pass seed from an earlier game to replay its computer moves
+        seedGame(&g, (argc > 1) ? strtoull(argv[1], NULL, 0) : (uint64_t)time(NULL));
+        printf("Seed: %llu\n", (unsigned long long)g.seed);
+        placeRandomFleet(&g, 1);
+
+        // timed states run speed times faster than real time, for automated runs
+        initializeScheduler(&u.timers, (argc > 2) ? atof(argv[2]) : 1);
+    }
+    u.shown = p1;
+    u.pauseTimer = -1;
+    u.ending = false;
+    u.quit = false;
 
     // create game windows and renderer
-    SDL_Renderer *renderer = initializeSDL(window, "Battleship", CELL_SIZE * BOARD_SIZE_X + 1, CELL_SIZE * (BOARD_SIZE_Y + 3) + 1);
+    SDL_Renderer *renderer = initializeSDL(window, "Battleship", WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (!renderer)
+        return 1;
+
+    // load font and text once for every frame
+    if (createRenderCache(renderer, &cache, WINDOW_WIDTH, WINDOW_HEIGHT))
+    {
+        teardown(renderer, window, &cache);
+        return 1;
+    }
 
     // display blank board
-    render(renderer, &p1);
+    render(renderer, &cache, p1, &g.players[1]);
 
     // game loop
-    // FPS dependent on constant game speed
-    while (running)
+    // game time advances in fixed steps while computer plays, otherwise sleep until input arrives or a timer is due
+    initializeInput(&input);
+    previous = getTime();
+    updateScheduler(&u.timers, previous);
+    while (!u.quit)
     {
-        // time exectuion of game logic and rendering
-        start = clock();
-        updateGame(&running, &started, &turn, &p1, &p2, &opGuess);
-        render(renderer, &p1); // render player's grid
-
-        // pause updating game state for ~1s
-        if (p1.pause)
-            i++;
-        if (i >= 99)
+        // computer's move is the only thing that can't wait for input or a timer
+        busy = g.running && !p1->pause && g.turn % 2 == 1 && net == NULL;
+
+        // sleep until next update or timer is due or input arrives
+        // an open network session is polled again after at most NET_POLL_TIME
+        timeout = busy ? TIMESTEP - lag : timeUntilTimer(&u.timers);
+        if (net != NULL && sessionSocket(net) >= 0 && (timeout < 0 || timeout > NET_POLL_TIME))
+            timeout = NET_POLL_TIME;
+        if (waitInput(&input, timeout))
+        {
+            // handle every event that arrived, in order
+            while (nextInput(&input, &event))
+            {
+                if (event.type == SDL_QUIT)
+                    u.quit = true;
+                handleInput(&g, &event, net);
+            }
+
+            // respond to input right away when game time isn't running
+            if (!busy && g.running)
+                updateGame(&g, net);
+        }
+
+        // apply other player's messages as soon as they arrive, leave if session failed
+        if (net != NULL)
         {
-            i = 0;
-            p1.pause = false;
+            if (pollSession(net, &g))
+            {
+                printf("Game ended: %s\n", sessionError(net->error));
+                u.quit = true;
+            }
+            else if (g.running)
+                updateGame(&g, net);
         }
 
-        end = clock();
+        // time passed since last loop, only counted while game time runs
+        current = getTime();
+        if (busy)
+            lag += current - previous;
+        previous = current;
 
-        sleepTime = SKIP_TICKS - ((double)(end - start) / CLOCKS_PER_SEC); // calculate time to sleep between rendering each frame
-        (sleepTime >= 0) ? SDL_Delay(sleepTime) : printf("Running %lfs behind!\n", -1 * sleepTime);
-    }
+        // catch up in fixed steps, dropping time that can't be caught up
+        for (updates = 0; lag >= TIMESTEP && g.running; updates++)
+        {
+            if (updates == MAX_UPDATES)
+            {
+                lag = 0;
+                break;
+            }
+            updateGame(&g, net);
+            lag -= TIMESTEP;
+        }
+        if (!busy)
+            lag = 0;
 
-    // display end of game msgs
-    SDL_Delay(1000);
-    p1.msg = 8; // game over msg
-    render(renderer, &p1);
-    SDL_Delay(1000);
-    p1.msg = (checkGameOver(&p2)) ? 16 : 17; // win or lose msg
-    render(renderer, &p1);
-    SDL_Delay(3000);
+        // timed states change what's shown w/o any input, so respond to them like input on player's turn
+        // computer's turn stays on fixed steps above
+        if (updateScheduler(&u.timers, current) && g.running && (g.turn % 2 == 0 || net != NULL))
+            updateGame(&g, net);
+        scheduleStates(&u);
 
-    // reveal computer player's board at end of game
-    p2.msg = 13; // opponent's board msg
-    render(renderer, &p2);
-    SDL_Delay(5000);
+        render(renderer, &cache, u.shown, (u.shown == p1) ? &g.players[1] : p1); // render shown grid if it changed
+    }
 
-    teardown(renderer, window);
+    teardown(renderer, window, &cache);
 
+    if (net != NULL)
+    {
+        if (net->trips)
+            printf("Round trip: %.3f ms average, %.3f ms max\n", 1e3 * net->rttTotal / net->trips, 1e3 * net->rttMax);
+        closeSession(net, NET_OK);
+        free(net);
+    }
+    freeGameStorage(&g);
     return 0;
 }
@@ -0,0 +1,363 @@
+/*
+Battleship engine benchmarks
+
+Times engine hot paths and whole self-play games w/o rendering.
+Every benchmark runs warm-up repetitions, then timed repetitions, and
+prints one CSV row of nanoseconds per operation across repetitions:
+
+name,reps,ops,median_ns,p99_ns,ops_per_sec
+
+ops is operations per repetition and ops_per_sec follows from the median,
+so for game benchmarks it is games per second. Output is meant to be kept
+and compared between builds to catch performance regressions.
+
+Allocations are counted by wrapping the allocator when linking, see Makefile.
+Benchmarks of steady state play, from computer shots to whole games, fail
+the run if their timed repetitions allocate anything.
+
+Usage: battleship-bench [reps] [seed]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "game.h"
+
+#define WARMUP_REPS 10         // untimed repetitions before each benchmark
+#define GAMES_PER_REP 10       // games played in each repetition of game benchmarks
+#define POOLED_GAMES 64        // games played at once in each repetition of pooled game benchmark
+#define SNAPSHOTS_PER_REP 1000 // snapshots taken and restored in each repetition of snapshot benchmark
+
+// state shared by setup and run of a benchmark
+typedef struct
+{
+    game *g;
+    uint64_t seed;  // seed of next game, so every repetition plays a new one
+    const strategy *strategy;
+    pool games;     // POOLED_GAMES games for pooled game benchmark
+    undoStack undo; // shots of make/unmake shot benchmark
+    void *snapshot; // snapshot of snapshot benchmark, see snapshotGame()
+} benchState;
+
+typedef struct
+{
+    const char *name;
+    void (*setup)(benchState *b); // untimed, before each repetition
+    long (*run)(benchState *b);   // timed, returns number of operations done
+    const strategy *strategy;     // computer strategy of both players
+    bool steady;                  // run must not allocate
+} benchmark;
+
+/* Allocation Counting
+    linker sends every allocation of the benchmarks and the engine through these
+*********************************************************************/
+long allocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int __real_posix_memalign(void **ptr, size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    allocations++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    allocations++;
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    allocations++;
+    return __real_posix_memalign(ptr, alignment, size);
+}
+/********************************************************************/
+
+// wall clock time in nanoseconds
+double nowNs(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int compareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Setups
+*********************************************************************/
+// for benchmarks that set up their own games
+void noSetup(benchState *b)
+{
+}
+
+// new game w/ both fleets placed at random, started
+void newGame(benchState *b)
+{
+    game *g = b->g;
+
+    initializeGame(g, &standardRules);
+    seedGame(g, b->seed++);
+    setStrategy(g, 0, b->strategy);
+    setStrategy(g, 1, b->strategy);
+    placeRandomFleet(g, 0);
+    placeRandomFleet(g, 1);
+    beginGame(g);
+}
+
+// new game w/ no hits counted on player 1's ships
+void newHits(benchState *b)
+{
+    newGame(b);
+    for (int i = 0; i < NSHIPS; i++)
+        b->g->players[1].ships[i].hitCount = 0;
+}
+/********************************************************************/
+
+/* Benchmarks
+*********************************************************************/
+// every ship at every cell and rotation of board
+long runCheckCells(benchState *b)
+{
+    player *p = &b->g->players[0];
+    long ops = 0;
+
+    for (int i = 0; i < NSHIPS; i++)
+    {
+        p->selectedShip = i;
+        for (int rot = 0; rot < 4; rot++)
+        {
+            for (int y = 1; y <= BOARD_SIZE; y++)
+            {
+                for (int x = 1; x <= BOARD_SIZE; x++, ops++)
+                    checkCells(p, &x, &y, &rot, 1);
+            }
+        }
+    }
+    p->selectedShip = -1;
+    return ops;
+}
+
+// player 0 shoots every cell of player 1's board
+long runTakeShot(benchState *b)
+{
+    for (int y = 1; y <= BOARD_SIZE; y++)
+    {
+        for (int x = 1; x <= BOARD_SIZE; x++)
+            takeShot(&b->g->players[0], &b->g->players[1], &b->g->running, x, y + BOARD_SIZE + 1);
+    }
+    return BOARD_SIZE * BOARD_SIZE;
+}
+
+// hit every cell of player 1's fleet until every ship sinks
+long runCheckSunk(benchState *b)
+{
+    player *p = &b->g->players[1];
+    long ops = 0;
+
+    for (int i = 0; i < NSHIPS; i++)
+    {
+        p->ships[i].sunk = false;
+        for (int j = 0; j < p->ships[i].len; j++, ops++)
+            checkSunk(p, &b->g->players[0], p->ships[i].cells[j] % p->width + 1, p->ships[i].cells[j] / p->width + 1);
+    }
+    p->shipsAfloat = NSHIPS;
+    return ops;
+}
+
+long runInitializeOpponent(benchState *b)
+{
+    for (int i = 0; i < 100; i++)
+        initializeOpponent(&b->g->players[1], &b->g->guesses[1]);
+    return 100;
+}
+
+// every computer shot of one game
+long runComputerShot(benchState *b)
+{
+    long ops = 0;
+
+    while (b->g->running)
+    {
+        computerShot(b->g);
+        ops++;
+    }
+    return ops;
+}
+
+// both players shoot their board in order until game is over, then every shot is taken back
+long runMakeShot(benchState *b)
+{
+    game *g = b->g;
+    long ops = 0;
+    int cell;
+
+    while (g->running)
+    {
+        cell = g->players[g->turn % 2].shotsTaken;
+        makeShot(g, &b->undo, cell % BOARD_SIZE + 1, cell / BOARD_SIZE + 1);
+        ops++;
+    }
+    rewindGame(g, &b->undo, 0);
+    return ops;
+}
+
+// game saved to a snapshot and restored from it
+long runSnapshot(benchState *b)
+{
+    for (int i = 0; i < SNAPSHOTS_PER_REP; i++)
+    {
+        snapshotGame(b->g, b->snapshot);
+        restoreGame(b->g, b->snapshot);
+    }
+    return SNAPSHOTS_PER_REP;
+}
+
+// whole games from placing fleets to last shot
+long runGames(benchState *b)
+{
+    for (int i = 0; i < GAMES_PER_REP; i++)
+    {
+        newGame(b);
+        while (b->g->running)
+            computerShot(b->g);
+    }
+    return GAMES_PER_REP;
+}
+
+// whole games taken from a pool and played a shot at a time in turn, like a server hosts them
+long runPooledGames(benchState *b)
+{
+    game *games[POOLED_GAMES], *g;
+    int playing = POOLED_GAMES;
+
+    for (int i = 0; i < POOLED_GAMES; i++)
+    {
+        g = games[i] = acquireGame(&b->games, NULL);
+        seedGame(g, b->seed++);
+        setStrategy(g, 0, b->strategy);
+        setStrategy(g, 1, b->strategy);
+        placeRandomFleet(g, 0);
+        placeRandomFleet(g, 1);
+        beginGame(g);
+    }
+    while (playing > 0)
+    {
+        for (int i = 0; i < POOLED_GAMES; i++)
+        {
+            if (games[i] == NULL)
+                continue;
+            computerShot(games[i]);
+            if (!games[i]->running)
+            {
+                releaseGame(&b->games, games[i]);
+                games[i] = NULL;
+                playing--;
+            }
+        }
+    }
+    return POOLED_GAMES;
+}
+/********************************************************************/
+
+// run benchmark and print its row
+// returns 0 on success, 1 if memory ran out or a steady benchmark allocated
+int runBenchmark(const benchmark *bench, benchState *b, int reps)
+{
+    double *ns = malloc(reps * sizeof(double)), start;
+    long ops, total = 0, before, allocated = 0;
+
+    if (ns == NULL)
+        return 1;
+    b->strategy = bench->strategy;
+
+    for (int i = -WARMUP_REPS; i < reps; i++)
+    {
+        bench->setup(b);
+        before = allocations;
+        start = nowNs();
+        ops = bench->run(b);
+        if (i >= 0)
+        {
+            ns[i] = (nowNs() - start) / ops;
+            total += ops;
+            allocated += allocations - before;
+        }
+    }
+    if (bench->steady && allocated)
+    {
+        fprintf(stderr, "%s allocated %ld times in %d repetitions\n", bench->name, allocated, reps);
+        free(ns);
+        return 1;
+    }
+
+    qsort(ns, reps, sizeof(double), compareDoubles);
+    printf("%s,%d,%ld,%.1f,%.1f,%.1f\n", bench->name, reps, total / reps, ns[reps / 2], ns[(reps * 99 + 99) / 100 - 1], 1e9 / ns[reps / 2]);
+    fflush(stdout);
+    free(ns);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int reps = (argc > 1) ? atoi(argv[1]) : 200;
+    benchState b = {NULL, (argc > 2) ? strtoull(argv[2], NULL, 0) : 1, NULL};
+    const benchmark benchmarks[] = {
+        {"checkCells", newGame, runCheckCells, &huntStrategy, false},
+        {"takeShot", newGame, runTakeShot, &huntStrategy, false},
+        {"checkSunk", newHits, runCheckSunk, &huntStrategy, false},
+        {"initializeOpponent", newGame, runInitializeOpponent, &huntStrategy, false},
+        {"computerShot/random", newGame, runComputerShot, &randomStrategy, true},
+        {"computerShot/hunt", newGame, runComputerShot, &huntStrategy, true},
+        {"computerShot/parity", newGame, runComputerShot, &parityStrategy, true},
+        {"computerShot/density", newGame, runComputerShot, &densityStrategy, true},
+        {"makeShot+unmakeShot", newGame, runMakeShot, &huntStrategy, true},
+        {"snapshotGame+restoreGame", newGame, runSnapshot, &huntStrategy, true},
+        {"game/random", noSetup, runGames, &randomStrategy, true},
+        {"game/hunt", noSetup, runGames, &huntStrategy, true},
+        {"game/parity", noSetup, runGames, &parityStrategy, true},
+        {"game/density", noSetup, runGames, &densityStrategy, true},
+        {"game/pooled", noSetup, runPooledGames, &huntStrategy, true},
+    };
+
+    if (reps < 1)
+    {
+        printf("Usage: %s [reps] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    b.g = createGame(NULL);
+    b.snapshot = malloc(snapshotSize(&standardRules));
+    if (b.g == NULL || b.snapshot == NULL || initializeGamePool(&b.games, POOLED_GAMES, NULL) || initializeUndoStack(&b.undo, 2 * BOARD_SIZE * BOARD_SIZE))
+        return 1;
+
+    printf("name,reps,ops,median_ns,p99_ns,ops_per_sec\n");
+    for (int i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    {
+        if (runBenchmark(&benchmarks[i], &b, reps))
+            return 1;
+    }
+
+    destroyGame(b.g);
+    freeGamePool(&b.games);
+    freeUndoStack(&b.undo);
+    free(b.snapshot);
+    return 0;
+}
@@ -0,0 +1,163 @@
+#ifndef __BITBOARD_H__
+#define __BITBOARD_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BOARD_SIZE 10 // width and height of each player's board
+
+// 128-bit mask w/ one bit per cell of a 10 x 10 board
+// cell (x, y) is bit (y - 1) * BOARD_SIZE + (x - 1), x and y from 1 to BOARD_SIZE
+typedef struct
+{
+    uint64_t w[2];
+} bitboard;
+
+/* Bitboard Operations
+*********************************************************************/
+// bit index of cell on board
+static inline int bbIndex(int x, int y)
+{
+    return (y - 1) * BOARD_SIZE + (x - 1);
+}
+
+static inline bitboard bbEmpty(void)
+{
+    bitboard b = {{0, 0}};
+    return b;
+}
+
+// all cells of board
+static inline bitboard bbFull(void)
+{
+    bitboard b = {{~(uint64_t)0, ((uint64_t)1 << (BOARD_SIZE * BOARD_SIZE - 64)) - 1}};
+    return b;
+}
+
+static inline bool bbTest(bitboard b, int i)
+{
+    return (b.w[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline void bbSet(bitboard *b, int i)
+{
+    b->w[i >> 6] |= (uint64_t)1 << (i & 63);
+}
+
+static inline void bbClear(bitboard *b, int i)
+{
+    b->w[i >> 6] &= ~((uint64_t)1 << (i & 63));
+}
+
+static inline bitboard bbOr(bitboard a, bitboard b)
+{
+    bitboard r = {{a.w[0] | b.w[0], a.w[1] | b.w[1]}};
+    return r;
+}
+
+static inline bitboard bbAnd(bitboard a, bitboard b)
+{
+    bitboard r = {{a.w[0] & b.w[0], a.w[1] & b.w[1]}};
+    return r;
+}
+
+// cells set in a but not in b
+static inline bitboard bbAndNot(bitboard a, bitboard b)
+{
+    bitboard r = {{a.w[0] & ~b.w[0], a.w[1] & ~b.w[1]}};
+    return r;
+}
+
+static inline bitboard bbXor(bitboard a, bitboard b)
+{
+    bitboard r = {{a.w[0] ^ b.w[0], a.w[1] ^ b.w[1]}};
+    return r;
+}
+
+// move every cell n bits higher, 0 <= n < 128
+static inline bitboard bbShift(bitboard b, int n)
+{
+    bitboard r;
+
+    if (n == 0)
+        return b;
+    if (n >= 64)
+    {
+        r.w[0] = 0;
+        r.w[1] = b.w[0] << (n - 64);
+        return r;
+    }
+    r.w[0] = b.w[0] << n;
+    r.w[1] = (b.w[1] << n) | (b.w[0] >> (64 - n));
+    return r;
+}
+
+// move every cell n bits lower, 0 <= n < 128
+static inline bitboard bbShiftDown(bitboard b, int n)
+{
+    bitboard r;
+
+    if (n == 0)
+        return b;
+    if (n >= 64)
+    {
+        r.w[0] = b.w[1] >> (n - 64);
+        r.w[1] = 0;
+        return r;
+    }
+    r.w[0] = (b.w[0] >> n) | (b.w[1] << (64 - n));
+    r.w[1] = b.w[1] >> n;
+    return r;
+}
+
+static inline bool bbIsEmpty(bitboard b)
+{
+    return (b.w[0] | b.w[1]) == 0;
+}
+
+static inline bool bbIntersects(bitboard a, bitboard b)
+{
+    return ((a.w[0] & b.w[0]) | (a.w[1] & b.w[1])) != 0;
+}
+
+// number of cells set
+static inline int bbCount(bitboard b)
+{
+    return __builtin_popcountll(b.w[0]) + __builtin_popcountll(b.w[1]);
+}
+
+// index of lowest set cell, which is cleared, b must not be empty
+static inline int bbPop(bitboard *b)
+{
+    int i;
+
+    if (b->w[0])
+    {
+        i = __builtin_ctzll(b->w[0]);
+        b->w[0] &= b->w[0] - 1;
+        return i;
+    }
+    i = __builtin_ctzll(b->w[1]);
+    b->w[1] &= b->w[1] - 1;
+    return 64 + i;
+}
+
+// index of nth set cell, counting from 0, b must have more than n cells set
+static inline int bbNth(bitboard b, int n)
+{
+    int i = 0;
+    uint64_t w = b.w[0];
+
+    if (n >= __builtin_popcountll(w))
+    {
+        n -= __builtin_popcountll(w);
+        w = b.w[1];
+        i = 64;
+    }
+    while (n-- > 0)
+        w &= w - 1; // clear lowest set bit
+    return i + __builtin_ctzll(w);
+}
+/********************************************************************/
+
+#endif
@@ -0,0 +1,171 @@
+/*
+Battleship bot clients
+
+Keeps many computer players connected to a battleship-server from one process,
+each joining a new game as soon as its last one ends, until the given number of
+games is played. Games count each bot's side, so a server game of two bots counts twice. Fleets are placed at random. Every bot owns its session and game,
+and one poll() waits on all of their sockets.
+
+Reports games played, how many ended in errors, win rate and the round trip
+time bots measured from sending a shot to receiving its result.
+
+Usage: battleship-bots [address] [port] [clients] [games] [strategy] [seed]
+strategy is random, hunt (default), parity or density
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "network.h"
+
+#define POLL_MS 100 // longest wait for a server message before checking bots again
+
+// one computer player and the game it's playing
+typedef struct
+{
+    netSession *n;
+    game *g;
+    bool playing; // bot is connected or waiting to connect, false once no games are left
+} bot;
+
+// connect bot for a new game
+// returns 0 on success, 1 if server can't be reached
+int joinGame(bot *b, const char *address, int port, const strategy *st, uint64_t seed)
+{
+    initializeGame(b->g, &b->g->rules); // client keeps rules between games, see readHello()
+    seedGame(b->g, seed);
+    if (joinSession(b->n, address, port, false))
+        return 1;
+    b->n->strategy = st;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *address = (argc > 1) ? argv[1] : "localhost";
+    int port = (argc > 2) ? atoi(argv[2]) : NET_PORT;
+    long clients = (argc > 3) ? atol(argv[3]) : 1000;
+    long games = (argc > 4) ? atol(argv[4]) : 10000;
+    const strategy *st = (argc > 5) ? findStrategy(argv[5]) : &huntStrategy;
+    uint64_t seed = (argc > 6) ? strtoull(argv[6], NULL, 0) : 1;
+    long started = 0, finished = 0, won = 0, errors[NET_SOCKET + 1] = {0}, trips = 0, active, waiting, unmatched = 0;
+    double rttTotal = 0, rttMax = 0, start, seconds;
+    struct pollfd *fds;
+    bot *bots, *b;
+    bool ready;
+
+    if (port < 1 || clients < 1 || games < 1 || st == NULL)
+    {
+        printf("Usage: %s [address] [port] [clients] [games] [strategy] [seed]\n", argv[0]);
+        printf("strategies: random, hunt, parity, density\n");
+        return 1;
+    }
+    if (clients > games)
+        clients = games;
+
+    bots = calloc(clients, sizeof(bot));
+    fds = calloc(clients, sizeof(struct pollfd));
+    if (bots == NULL || fds == NULL)
+        return 1;
+    for (long i = 0; i < clients; i++)
+    {
+        bots[i].n = malloc(sizeof(netSession));
+        bots[i].g = createGame(NULL);
+        if (bots[i].n == NULL || bots[i].g == NULL)
+            return 1;
+    }
+
+    start = netTime();
+    for (long i = 0; i < clients; i++)
+    {
+        if (joinGame(&bots[i], address, port, st, seed + started++))
+        {
+            printf("Can't connect to %s port %d\n", address, port);
+            return 1;
+        }
+        bots[i].playing = true;
+    }
+
+    for (active = clients; active > 0;)
+    {
+        // sleep until a server message arrives, unless a bot can shoot right away
+        ready = false;
+        waiting = 0;
+        for (long i = 0; i < clients; i++)
+        {
+            b = &bots[i];
+            fds[i].fd = b->playing ? sessionSocket(b->n) : -1;
+            fds[i].events = POLLIN;
+            ready = ready || (b->playing && localTurn(b->n, b->g));
+            waiting += b->playing && b->n->state == NET_CONNECTING;
+        }
+
+        // server only pairs clients that connect to the same loop, so last bots may never be matched
+        if (started == games && waiting == active)
+        {
+            unmatched = waiting;
+            break;
+        }
+        poll(fds, clients, ready ? 0 : POLL_MS);
+
+        for (long i = 0; i < clients; i++)
+        {
+            b = &bots[i];
+            if (!b->playing || (fds[i].revents == 0 && !localTurn(b->n, b->g)))
+                continue;
+
+            pollSession(b->n, b->g);
+            if (b->n->state == NET_PLACING && !b->n->localReady && (placeRandomFleet(b->g, 0) || commitFleet(b->n, b->g)))
+                closeSession(b->n, NET_RULES);
+            if (localTurn(b->n, b->g))
+                sendComputerShot(b->n, b->g);
+            if (b->n->state != NET_OVER && b->n->state != NET_CLOSED)
+                continue;
+
+            // game ended, count it and join next one
+            closeSession(b->n, NET_OK);
+            finished++;
+            errors[b->n->error]++;
+            if (b->n->error == NET_OK && gameWinner(b->g) == 0)
+                won++;
+            trips += b->n->trips;
+            rttTotal += b->n->rttTotal;
+            if (b->n->rttMax > rttMax)
+                rttMax = b->n->rttMax;
+            if (started == games || joinGame(b, address, port, st, seed + started++))
+            {
+                b->playing = false;
+                active--;
+            }
+        }
+    }
+    seconds = netTime() - start;
+
+    printf("games      %ld\n", finished);
+    if (unmatched)
+        printf("unmatched  %ld bots never found an opponent\n", unmatched);
+    for (int e = NET_DISCONNECTED; e <= NET_SOCKET; e++)
+    {
+        if (errors[e])
+            printf("errors     %ld, %s\n", errors[e], sessionError(e));
+    }
+    printf("won        %.2f%%\n", finished ? 100.0 * won / finished : 0);
+    printf("seconds    %.3f\n", seconds);
+    printf("games/sec  %.1f\n", finished / seconds);
+    if (trips)
+        printf("round trip %.3f ms average, %.3f ms max over %ld trips\n", 1e3 * rttTotal / trips, 1e3 * rttMax, trips);
+
+    for (long i = 0; i < clients; i++)
+    {
+        closeSession(bots[i].n, NET_OK);
+        free(bots[i].n);
+        destroyGame(bots[i].g);
+    }
+    free(bots);
+    free(fds);
+    return 0;
+}
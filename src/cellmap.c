@@ -0,0 +1,139 @@
+#include <stdlib.h>
+#include "cellmap.h"
+
+#define MIN_CAPACITY 64
+
+// slot a key hashes to, high bits of a Fibonacci hash spread neighbouring cells across the table
+size_t cellSlot(const cellMap *m, uint32_t key)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & (m->capacity - 1);
+}
+
+// move every stored cell to a table of given capacity
+// returns 0 on success, 1 if memory ran out
+int resizeCellMap(cellMap *m, size_t capacity)
+{
+    uint32_t *keys = calloc(capacity, sizeof(uint32_t));
+    int *values = malloc(capacity * sizeof(int));
+    cellMap resized = {keys, values, capacity, m->count};
+    size_t slot;
+
+    if (keys == NULL || values == NULL)
+    {
+        free(keys);
+        free(values);
+        return 1;
+    }
+
+    for (size_t i = 0; i < m->capacity; i++)
+    {
+        if (!m->keys[i])
+            continue;
+        slot = cellSlot(&resized, m->keys[i]);
+        while (keys[slot])
+            slot = (slot + 1) & (capacity - 1);
+        keys[slot] = m->keys[i];
+        values[slot] = m->values[i];
+    }
+
+    free(m->keys);
+    free(m->values);
+    *m = resized;
+    return 0;
+}
+
+/* Cell Maps
+*********************************************************************/
+// empty map w/o any memory allocated
+void initializeCellMap(cellMap *m)
+{
+    m->keys = NULL;
+    m->values = NULL;
+    m->capacity = 0;
+    m->count = 0;
+}
+
+// remove every cell, keeping memory for reuse
+void clearCellMap(cellMap *m)
+{
+    for (size_t i = 0; i < m->capacity; i++)
+        m->keys[i] = 0;
+    m->count = 0;
+}
+
+void freeCellMap(cellMap *m)
+{
+    free(m->keys);
+    free(m->values);
+    initializeCellMap(m);
+}
+
+// value stored for cell, missing if cell isn't stored
+int cellMapGet(const cellMap *m, int cell, int missing)
+{
+    uint32_t key = cell + 1;
+    size_t slot;
+
+    if (m->count == 0)
+        return missing;
+    for (slot = cellSlot(m, key); m->keys[slot]; slot = (slot + 1) & (m->capacity - 1))
+    {
+        if (m->keys[slot] == key)
+            return m->values[slot];
+    }
+    return missing;
+}
+
+// store value for cell, replacing any value stored before
+// returns 0 on success, 1 if memory ran out
+int cellMapSet(cellMap *m, int cell, int value)
+{
+    uint32_t key = cell + 1;
+    size_t slot;
+
+    // keep table at most half full so probes stay short
+    if (2 * (m->count + 1) > m->capacity && resizeCellMap(m, m->capacity ? 2 * m->capacity : MIN_CAPACITY))
+        return 1;
+
+    for (slot = cellSlot(m, key); m->keys[slot]; slot = (slot + 1) & (m->capacity - 1))
+    {
+        if (m->keys[slot] == key)
+        {
+            m->values[slot] = value;
+            return 0;
+        }
+    }
+    m->keys[slot] = key;
+    m->values[slot] = value;
+    m->count++;
+    return 0;
+}
+
+void cellMapRemove(cellMap *m, int cell)
+{
+    uint32_t key = cell + 1;
+    size_t slot, next, home;
+
+    if (m->count == 0)
+        return;
+    for (slot = cellSlot(m, key); m->keys[slot] != key; slot = (slot + 1) & (m->capacity - 1))
+    {
+        if (!m->keys[slot])
+            return;
+    }
+
+    // shift later cells of the probe run back into the hole so lookups still find them
+    for (next = (slot + 1) & (m->capacity - 1); m->keys[next]; next = (next + 1) & (m->capacity - 1))
+    {
+        home = cellSlot(m, m->keys[next]);
+        if (((next - home) & (m->capacity - 1)) >= ((next - slot) & (m->capacity - 1)))
+        {
+            m->keys[slot] = m->keys[next];
+            m->values[slot] = m->values[next];
+            slot = next;
+        }
+    }
+    m->keys[slot] = 0;
+    m->count--;
+}
+/********************************************************************/
@@ -0,0 +1,27 @@
+#ifndef __CELLMAP_H__
+#define __CELLMAP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// open addressing hash map from cell index to value, for boards too big for per-cell arrays
+// memory grows w/ cells stored, not w/ board area
+typedef struct
+{
+    uint32_t *keys;  // cell index + 1 of each slot, 0 if slot is empty
+    int *values;
+    size_t capacity; // slots, power of 2, 0 until first cell is stored
+    size_t count;    // cells stored
+} cellMap;
+
+/* Cell Maps
+*********************************************************************/
+void initializeCellMap(cellMap *m);
+void clearCellMap(cellMap *m);
+void freeCellMap(cellMap *m);
+int cellMapGet(const cellMap *m, int cell, int missing);
+int cellMapSet(cellMap *m, int cell, int value);
+void cellMapRemove(cellMap *m, int cell);
+/********************************************************************/
+
+#endif
@@ -1,66 +1,6 @@
-#include <stdio.h>
+#include <stddef.h>
 #include "engine.h"
 
-// initialize SDL events, inputs, window, and renderer
-SDL_Renderer *initializeSDL(SDL_Window *window, const char *title, int width, int height)
-{
-    // Initializes the timer, audio, video, joystick,
-    // haptic, gamecontroller and events subsystems
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
-    {
-        printf("Error initializing SDL: %s\n", SDL_GetError());
-        return 0;
-    }
-
-    //Initialize SDL_ttf
-    if (TTF_Init() != 0)
-    {
-        printf("Error initializing SDL_ttf: %s\n", TTF_GetError());
-        return 0;
-    }
-
-    // Create a window
-    window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, 0);
-    if (!window)
-    {
-        printf("Error creating window: %s\n", SDL_GetError());
-        SDL_Quit();
-        return 0;
-    }
-
-    // Create a renderer
-    Uint32 render_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC;
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, render_flags);
-    if (!renderer)
-    {
-        printf("Error creating renderer: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 0;
-    }
-
-    return renderer;
-}
-
-// Release SDL resources
-void teardown(SDL_Renderer *renderer, SDL_Window *window)
-{
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
-    TTF_Quit();
-    SDL_Quit();
-}
-
-// get input from user
-// e.g. keyboard and mouse
-SDL_Event getInput()
-{
-    SDL_Event event;
-
-    while (SDL_PollEvent(&event))
-        return event;
-}
-
 // return selected message
 const char *message(int msg)
 {
@@ -107,86 +47,180 @@ const char *message(int msg)
     }
 }
 
+// show msg in player's message box
+void setMessage(player *p, int msg)
+{
+    if (p->msg != msg)
+        p->dirty = true;
+    p->msg = msg;
+}
+
 /* Game Mechanics
 **********************************************************************
 *********************************************************************/
 
 /* Ship Placement
 *********************************************************************/
-//return offset corresponding to rotation
-int getRotation(int rotation)
+// direction of ship from its center for each rotation
+void shipDirection(int rotation, int *dx, int *dy)
 {
+    *dx = 0;
+    *dy = 0;
     switch (rotation)
     {
     case 0:
-        return BOARD_SIZE_Y;
+        *dx = 1;
+        break;
+    case 1:
+        *dy = 1;
+        break;
     case 2:
-        return -BOARD_SIZE_Y;
+        *dx = -1;
+        break;
     case 3:
-        return -1;
-    default:
-        return rotation;
+        *dy = -1;
+        break;
     }
 }
 
-// calculate the x and y position on grid from given position on grid
-void calculateOffset(player *p, int *pos, int *x, int *y)
+// build mask of cells covered by ship w/ center at x, y on board
+// returns false if any part of ship is outside of 10 x 10 board
+bool shipMask(int len, int center, int x, int y, int rotation, bitboard *mask)
 {
-    int offset;
+    int dx, dy, cellX, cellY;
 
-    offset = pos - &p->grid[0][0];
-    *x = offset / BOARD_SIZE_Y;
-    *y = offset % BOARD_SIZE_Y;
+    shipDirection(rotation, &dx, &dy);
+    *mask = bbEmpty();
+    for (int i = 0; i < len; i++)
+    {
+        cellX = x + (i - center) * dx;
+        cellY = y + (i - center) * dy;
+        if (cellX > BOARD_SIZE || cellX < 1 || cellY > BOARD_SIZE || cellY < 1)
+            return false;
+        bbSet(mask, bbIndex(cellX, cellY));
+    }
+    return true;
 }
 
-// check if cells are occupied by another ship
-bool checkCells(player *p, int *x, int *y, int *rotation, int placing)
+// check that ship w/ center at x, y fits on player's board w/o overlapping another ship
+bool shipFits(player *p, ship *s, int x, int y, int rotation)
 {
-    ship *s = &p->ships[p->selectedShip];
-    int rot, *newPos, newXPos, newYPos, *newCenter = s->pos[s->center];
+    int dx, dy, cellX, cellY, id;
 
-    // check if center point can be moved
-    if (x != NULL && y != NULL)
+    shipDirection(rotation, &dx, &dy);
+    for (int i = 0; i < s->len; i++)
     {
-        if (p->grid[*x][*y] == 1 && s->pos[s->center] != &p->grid[*x][*y])
-        {
-            p->msg = 3; // can't place ship msg
-            p->pause = true;
+        cellX = x + (i - s->center) * dx;
+        cellY = y + (i - s->center) * dy;
+        if (cellX > p->width || cellX < 1 || cellY > p->height || cellY < 1)
+            return false;
+        id = shipAtCell(p, cellIndex(p, cellX, cellY));
+        if (id != NO_SHIP && id != s - p->ships)
             return false;
-        }
-        newCenter = &p->grid[*x][*y]; // if cell is clear, set new center equal to pointer to new cell
     }
+    return true;
+}
 
-    // apply rotation if necessary
-    rot = (rotation != NULL) ? getRotation(*rotation) : getRotation(s->rot);
-
-    // check if rest of ship can be moved
+// take ship off player's ship map and ship layer
+void removeShip(player *p, ship *s)
+{
+    if (s->cells[0] < 0)
+        return;
     for (int i = 0; i < s->len; i++)
     {
-        newPos = newCenter - ((s->center - i) * rot);
-        if (placing)
-        {
-            // calculate new position
-            calculateOffset(p, newPos, &newXPos, &newYPos);
+        if (p->sparse)
+            cellMapRemove(&p->shipMap, s->cells[i]);
+        else
+            p->shipAt[s->cells[i]] = NO_SHIP;
+    }
+    s->cells[0] = -1;
 
-            // ship must be placed within 10 x 10 board
-            if (newXPos > 10 || newXPos < 1 || newYPos > 10 || newYPos < 1)
-            {
-                p->msg = 3; // can't place ship msg
-                p->pause = true;
-                return false;
-            }
-        }
+    p->fleet = bbAndNot(p->fleet, s->mask);
+    s->mask = bbEmpty();
+}
+
+// put ship w/ center at x, y and its current rotation on player's ship map and ship layer
+// ship must be off board and fit, see shipFits()
+// returns 0 if added, 1 if memory for a sparse board's ship map ran out
+int addShip(player *p, ship *s, int x, int y)
+{
+    int dx, dy;
 
-        // center if cells are clear
-        if (s->pos[i] != newCenter && *newPos == 1)
+    s->x = x;
+    s->y = y;
+    shipDirection(s->rot, &dx, &dy);
+    for (int i = 0; i < s->len; i++)
+    {
+        s->cells[i] = cellIndex(p, x + (i - s->center) * dx, y + (i - s->center) * dy);
+        if (!p->sparse)
+            p->shipAt[s->cells[i]] = s - p->ships;
+        else if (cellMapSet(&p->shipMap, s->cells[i], s - p->ships))
         {
-            p->msg = 3; // can't place ship msg
-            p->pause = true;
-            return false;
+            // take back cells already added
+            while (i-- > 0)
+                cellMapRemove(&p->shipMap, s->cells[i]);
+            s->cells[0] = -1;
+            return 1;
         }
     }
 
+    if (p->bitboards)
+    {
+        shipMask(s->len, s->center, x, y, s->rot, &s->mask);
+        p->fleet = bbOr(p->fleet, s->mask);
+    }
+    return 0;
+}
+
+// initial position of ship's center on display grid, in its row right of the board
+void initialShipPos(player *p, ship *s, int *x, int *y)
+{
+    *x = 13 + s->center;
+    *y = (s - p->ships) * 2 + 7;
+}
+
+// move ship back to its initial position if not placed, placed ships are already at their center on board
+// for ships placed w/o the ship selection area
+void updateShipPos(player *p, ship *s)
+{
+    if (!s->isPlaced)
+        initialShipPos(p, s, &s->x, &s->y);
+    p->dirty = true;
+}
+
+// recalculate ship's cells from its position and update player's ship layer and ship map
+void updateShipCells(player *p, ship *s)
+{
+    removeShip(p, s);
+    if (s->isPlaced)
+        addShip(p, s, s->x, s->y);
+}
+
+// check if cells are occupied by another ship
+bool checkCells(player *p, int *x, int *y, int *rotation, int placing)
+{
+    ship *s;
+    int centerX, centerY, rot;
+
+    // selection area only ever holds the selected ship
+    if (!placing)
+        return true;
+
+    s = &p->ships[p->selectedShip];
+
+    // use current center and rotation unless new ones are given
+    centerX = (x != NULL) ? *x : s->x;
+    centerY = (y != NULL) ? *y : s->y;
+    rot = (rotation != NULL) ? *rotation : s->rot;
+
+    // ship must be placed within board and not overlap other ships
+    if (!shipFits(p, s, centerX, centerY, rot))
+    {
+        setMessage(p, 3); // can't place ship msg
+        p->pause = true;
+        return false;
+    }
+
     return true;
 }
 
@@ -204,41 +238,11 @@ void rotateShip(player *p, int rotation)
         if (p->ships[p->selectedShip].isPlaced)
             placing = 1; // if ship is placed, set placing to 1
         if (checkCells(p, NULL, NULL, &rot, placing))
-            p->ships[p->selectedShip].rot = rot;
-    }
-}
-
-// update position pointer arrays and grids to place ships
-// check cells before call placeShips()
-void placeShips(player *p)
-{
-    ship *s;
-    int rot, x, y;
-
-    for (int i = 0; i < NSHIPS; i++)
-    {
-        s = &p->ships[i];
-
-        // apply rotation
-        rot = getRotation(s->rot);
-
-        // place ship w/ rotation
-        for (int j = 0; j < s->len; j++)
         {
-            if (s->pos[j] == s->pos[s->center])
-            {
-                *s->pos[s->center] = 1; // place center of ship
-                continue;
-            }
-            *s->pos[j] = 0;
-            s->pos[j] = s->pos[s->center] - ((s->center - j) * rot); // calculate offset from center for each block based on rotation
-            *s->pos[j] = 1;
+            p->ships[p->selectedShip].rot = rot;
+            updateShipCells(p, &p->ships[p->selectedShip]);
+            p->dirty = true;
         }
-
-        // update position of texture rectangle
-        calculateOffset(p, s->pos[0], &x, &y);
-        s->numberRect.x = x * CELL_SIZE + 2;
-        s->numberRect.y = y * CELL_SIZE + 2;
     }
 }
 
@@ -247,15 +251,10 @@ void clearSelectedShip(player *p)
 {
     ship *s = &p->ships[p->selectedShip];
 
-    // clear ship's current position
-    for (int i = 0; i < s->len; i++)
-    {
-        *s->pos[i] = 0;
-    }
-
     // reset rotation and position of center
     s->rot = 0;
-    s->pos[s->center] = s->initCenterPos;
+    initialShipPos(p, s, &s->x, &s->y);
+    p->dirty = true;
 }
 
 // move selected ship to a position on the board
@@ -268,17 +267,19 @@ int placeSelectedShip(player *p, int x, int y)
     {
         s = &p->ships[p->selectedShip];
 
-        // ship must be placed on 10 x 10 board
-        if (x < 11 && x > 0 && y < 11 && y > 0)
+        // ship must be placed on board
+        if (x <= p->width && x > 0 && y <= p->height && y > 0)
             // check that new position on board is clear
             if (checkCells(p, &x, &y, NULL, 1))
             {
-                *s->pos[s->center] = 0;
-                s->pos[s->center] = &p->grid[x][y]; // move center to new position
-                s->isPlaced = true;                 // ship is now placed on board
+                s->x = x; // move center to new position
+                s->y = y;
+                s->isPlaced = true; // ship is now placed on board
+                updateShipCells(p, s);
+                p->dirty = true;
                 return 0;
             }
-        p->msg = 3; // can't place ship msg
+        setMessage(p, 3); // can't place ship msg
         p->pause = true;
         return 1;
     }
@@ -304,11 +305,13 @@ int setSelectedShip(bool started, player *p, int selectedShip)
             p->selectedShip = selectedShip;
             s = &p->ships[p->selectedShip];
             s->isPlaced = false; // if selected, the ship is not currently placed
-            *s->pos[s->center] = 0;
-            s->pos[s->center] = &p->grid[x][y]; // move center to selected ship box
+            updateShipCells(p, s);
+            s->x = x; // move center to selected ship box
+            s->y = y;
+            p->dirty = true;
             return 0;
         }
-        p->msg = 2; // can't select ship msg
+        setMessage(p, 2); // can't select ship msg
         p->pause = true;
     }
     return 1;
@@ -317,109 +320,222 @@ int setSelectedShip(bool started, player *p, int selectedShip)
 
 /* Shooting
 *********************************************************************/
-// checks opponent's ships to see if sunk
+// count hit on opponent's ship at x, y and check if it sunk
+// ship is found from the ship map, so this costs the same for any number of ships
 int checkSunk(player *p2, player *p1, int x, int y)
 {
     ship *s;
-    bool correctShip, sunk;
+    int id = shipAtCell(p2, cellIndex(p2, x, y));
 
-    // find ship in opponent's grid that matches the position of the hit
-    // and is sunk
-    for (int i = 0; i < NSHIPS; i++)
-    {
-        s = &p2->ships[i];
-        correctShip = false;
-        sunk = true;
-        if (!s->sunk)
-        {
-            for (int j = 0; j < s->len; j++)
-            {
-                // every cell of ship must be hit
-                if (*s->pos[j] != 3)
-                    sunk = false;
-
-                // the ship must contain the position of the hit
-                if (s->pos[j] == &p2->grid[x][y])
-                {
-                    correctShip = true;
-                }
-            }
-            if (correctShip && sunk)
-            {
-                s->sunk = true;
+    if (id == NO_SHIP)
+        return 0;
+    s = &p2->ships[id];
 
-                // ship sunk msg
-                p1->msg = 7;
-                p2->msg = 9;
-                p1->pause = true;
-                p2->pause = true;
+    // every cell of ship must be hit
+    if (s->sunk || ++s->hitCount < s->len)
+        return 0;
 
-                return 1;
-            }
-        }
-    }
-    return 0;
+    s->sunk = true;
+    p2->shipsAfloat--;
+
+    // ship sunk msg
+    setMessage(p1, 7);
+    setMessage(p2, 9);
+    p1->pause = true;
+    p2->pause = true;
+
+    return 1;
 }
 
 // if all of player's ships are sunk, game is over
 int checkGameOver(player *p)
 {
-    ship *s;
+    return p->shipsAfloat == 0;
+}
+
+// record p1's shot at cell of opponent's board
+// returns 0 if recorded, 1 if memory for a sparse board's shots ran out
+int setShot(player *p1, int cell, int shot)
+{
+    if (p1->sparse)
+        return cellMapSet(&p1->shotMap, cell, shot);
+    p1->shots[cell] = shot;
+    return 0;
+}
+
+// mark p1's shot at x, y on p2's board as a miss or hit, w/ messages for both players
+// returns 0 if marked, 1 if memory for a sparse board's shots ran out
+int markShot(player *p1, player *p2, int x, int y, int shot)
+{
+    int cell = cellIndex(p2, x, y);
+
+    if (setShot(p1, cell, shot))
+        return 1;
+    p1->shotsTaken++;
+    p1->lastShot = cell;
 
-    for (int i = 0; i < NSHIPS; i++)
+    // display miss
+    if (shot == SHOT_MISS)
     {
-        s = &p->ships[i];
-        if (!s->sunk)
-            return 0;
+        if (p1->bitboards)
+            bbSet(&p1->misses, cell);
+        p1->dirty = true;
+        setMessage(p1, 5); // miss msg
+        setMessage(p2, 15);
+        p1->pause = true;
+        p2->pause = true;
+        return 0;
     }
-    return 1;
+
+    // display hit
+    if (p1->bitboards)
+        bbSet(&p1->hits, cell);
+    p1->dirty = true;
+    p2->dirty = true;
+    setMessage(p1, 6); // hit msg
+    setMessage(p2, 14);
+    p1->pause = true;
+    p2->pause = true;
+    return 0;
 }
 
-// p1 shoots at p2
+// check that p1 can shoot at x, y on p2's board
+bool shotAllowed(player *p1, player *p2, int x, int y)
+{
+    // shot must be on board
+    if (x > p2->width || x < 1 || y > p2->height || y < 1)
+        return false;
+
+    // check is player already took shot with matching position
+    if (shotAt(p1, cellIndex(p2, x, y)))
+    {
+        setMessage(p1, 4); // shot taken already msg
+        p1->pause = true;
+        p2->pause = true;
+        return false;
+    }
+    return true;
+}
+
+// p1 shoots at x, y on p2's board
+// returns 0 if shot not taken, 1 for miss, 2 for hit, 3 for hit that sank a ship
+int fireAt(player *p1, player *p2, bool *running, int x, int y)
+{
+    if (!shotAllowed(p1, p2, x, y))
+        return 0;
+
+    if (shipAtCell(p2, cellIndex(p2, x, y)) == NO_SHIP)
+        return markShot(p1, p2, x, y, SHOT_MISS) ? 0 : 1;
+
+    if (markShot(p1, p2, x, y, SHOT_HIT))
+        return 0;
+    if (checkSunk(p2, p1, x, y)) // check is ship was sunk
+    {
+        if (checkGameOver(p2)) // check if game over if ship was sunk
+            *running = false;
+        return 3;
+    }
+    return 2;
+}
+
+// p1's shot at x, y on p2's board whose result was resolved by another engine,
+// for boards whose ships aren't known, like a network opponent's
+// sunk ship must be marked sunk on p2 by caller
+// returns result, 0 if shot not allowed or result isn't a shot's result, see fireAt()
+int recordShot(player *p1, player *p2, bool *running, int x, int y, int result)
+{
+    if (result < 1 || result > 3 || !shotAllowed(p1, p2, x, y))
+        return 0;
+    if (markShot(p1, p2, x, y, (result == 1) ? SHOT_MISS : SHOT_HIT))
+        return 0;
+    if (result == 3)
+    {
+        p2->shipsAfloat--;
+
+        // ship sunk msg
+        setMessage(p1, 7);
+        setMessage(p2, 9);
+        if (checkGameOver(p2))
+            *running = false;
+    }
+    return result;
+}
+
+// p1 shoots at x, y on p1's bottom guessing grid
 int takeShot(player *p1, player *p2, bool *running, int x, int y)
 {
     // shot must be within bottom guessing grid
     if (x < 11 && x > 0 && y < 22 && y > 11)
+        return fireAt(p1, p2, running, x, y - 11);
+    return 0;
+}
+/********************************************************************/
+
+/* Search
+*********************************************************************/
+// p1 shoots at cell of p2's board, only changing shots, hits and ships, and records what changed in r
+// leaves messages alone, so shots are cheap to try and take back
+// returns 0 if cell was already shot or memory for a sparse board's shots ran out, otherwise same as fireAt()
+int makeShotAt(player *p1, player *p2, int cell, shotRecord *r)
+{
+    ship *s;
+    int id;
+
+    if (shotAt(p1, cell))
+        return 0;
+    id = shipAtCell(p2, cell);
+    if (setShot(p1, cell, (id == NO_SHIP) ? SHOT_MISS : SHOT_HIT))
+        return 0;
+
+    r->cell = cell;
+    r->lastShot = p1->lastShot;
+    r->ship = id;
+    p1->shotsTaken++;
+    p1->lastShot = cell;
+
+    if (id == NO_SHIP)
     {
-        // check is player already took shot with matching position
-        if (p1->grid[x][y] == 2 || p1->grid[x][y] == 3)
-        {
-            p1->msg = 4; // shot taken already msg
-            p1->pause = true;
-            p2->pause = true;
-            return 0;
-        }
+        if (p1->bitboards)
+            bbSet(&p1->misses, cell);
+        return 1;
+    }
 
-        // display miss
-        if (p2->grid[x][y - 11] == 0)
-        {
-            p1->grid[x][y] = 2;
-            p1->msg = 5; // miss msg
-            p2->msg = 15;
-            p1->pause = true;
-            p2->pause = true;
-            return 1;
-        }
+    if (p1->bitboards)
+        bbSet(&p1->hits, cell);
+    s = &p2->ships[id];
+    if (++s->hitCount < s->len)
+        return 2;
+    s->sunk = true;
+    p2->shipsAfloat--;
+    return 3;
+}
+
+// take back p1's shot at p2's board recorded by makeShotAt(), must be p1's last shot
+void unmakeShotAt(player *p1, player *p2, const shotRecord *r)
+{
+    ship *s;
 
-        // display hit
-        if (p2->grid[x][y - 11] == 1)
+    if (r->ship != NO_SHIP)
+    {
+        s = &p2->ships[r->ship];
+        if (s->hitCount-- == s->len)
         {
-            p1->grid[x][y] = 3;
-            p2->grid[x][y - 11] = 3;
-            p1->msg = 6; // hit msg
-            p2->msg = 14;
-            p1->pause = true;
-            p2->pause = true;
-            if (checkSunk(p2, p1, x, y - 11)) // check is ship was sunk
-            {
-                if (checkGameOver(p2)) // check if game over if ship was sunk
-                    *running = false;
-                return 3;
-            }
-            return 2;
+            s->sunk = false;
+            p2->shipsAfloat++;
         }
     }
-    return 0;
+
+    if (p1->bitboards)
+    {
+        bbClear(&p1->hits, r->cell);
+        bbClear(&p1->misses, r->cell);
+    }
+    if (p1->sparse)
+        cellMapRemove(&p1->shotMap, r->cell);
+    else
+        p1->shots[r->cell] = 0;
+    p1->shotsTaken--;
+    p1->lastShot = r->lastShot;
 }
 /********************************************************************/
 
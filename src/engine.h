@@ -1,33 +1,60 @@
 #ifndef __ENGINE_H__
 #define __ENGINE_H__
 
-#include <SDL2/SDL.h>
-#include <SDL2/SDL_ttf.h>
 #include <stdbool.h>
+#include "bitboard.h"
+#include "cellmap.h"
+#include "rules.h"
 
 #define BOARD_SIZE_X 19
 #define BOARD_SIZE_Y 23
-#define CELL_SIZE 36
-#define NSHIPS 5
+#define NSHIPS 5         // ships in standard fleet, each w/ a selection key in the SDL game
+#define MAX_STAGED_LEN 5 // longest ship that fits in ship selection area
+#define NMESSAGES 18     // number of messages message() returns text for
+#define NO_SHIP -1       // shipAt value of cells w/o a ship
 
-#define FPS 100
-#define SKIP_TICKS 1000 / FPS
+// shots values of each cell
+#define SHOT_MISS 1
+#define SHOT_HIT 2
 
 // general ship struct
 typedef struct
 {
-    int *pos[5];          // pointers to grid cells occupied by ship
-    int len, center, rot; // rotation- 0 left, 1 up, 2 right, 3 down
-    int *initCenterPos;   // initial position of ship's center
+    int x, y;                // position of ship's center, on board once placed, in ship selection area of display grid otherwise
+    int len, center, rot;    // rotation- 0 left, 1 up, 2 right, 3 down
     bool isPlaced, sunk;
-    SDL_Rect numberRect; // rectangle for rendering texture containing ship's selection number
+    int hitCount;            // cells of ship hit so far, sunk once it reaches len
+    int cells[MAX_SHIP_LEN]; // index of each cell of ship on player's board, cells[0] is -1 if not on board
+    bitboard mask;           // cells occupied by ship on 10 x 10 board, empty if not placed
 } ship;
 
 // general player struct
 typedef struct
 {
-    // player's boards
-    int grid[BOARD_SIZE_X][BOARD_SIZE_Y];
+    // board size and fleet size from game's rules
+    int width, height;
+    int nships;
+    bool bitboards; // board is 10 x 10, so bitboard layers are kept and fast paths use them
+    bool sparse;    // board is too big for per-cell arrays, so cell maps are used instead
+
+    // board layers used by game mechanics on 10 x 10 boards
+    bitboard fleet;  // cells occupied by player's placed ships
+    bitboard hits;   // player's shots that hit opponent's ships
+    bitboard misses; // player's shots that missed
+
+    // board arrays used by game mechanics on boards that aren't sparse, indexed by cellIndex()
+    // width * height cells each, in storage of player's game, see layoutGame()
+    // use shotAt() and shipAtCell() to read them on any board
+    unsigned char *shots; // player's shots on opponent's board, 0 if not shot, SHOT_MISS or SHOT_HIT
+    short *shipAt;        // ship occupying each cell of player's board, NO_SHIP if empty
+
+    // same as shots and shipAt on sparse boards, only shot cells and ship cells are stored
+    cellMap shotMap;
+    cellMap shipMap;
+
+    int shotsTaken;
+    int lastShot;    // cell of player's last shot on opponent's board, -1 before first shot
+    int shipsAfloat; // ships not sunk yet
 
     // number of message to display in message box
     int msg;
@@ -35,17 +62,44 @@ typedef struct
     // set true to display message and delay game update for 99 frames
     bool pause;
 
-    // player's ships
-    ship ships[NSHIPS];
+    // set when ships, shots or msg change, cleared once player's board is rendered
+    // the SDL game draws boards from ships and shots, so the engine keeps no display grid
+    bool dirty;
+
+    // player's ships, nships of them in storage of player's game
+    ship *ships;
     int selectedShip;
 } player;
 
-// SDL abstractions
-SDL_Renderer *initializeSDL(SDL_Window *window, const char *title, int width, int height);
-void teardown(SDL_Renderer *renderer, SDL_Window *window);
-SDL_Event getInput();
+// what one shot made w/ makeShotAt() changed, so unmakeShotAt() can take it back
+typedef struct
+{
+    int cell;     // cell shot on opponent's board
+    int lastShot; // shooter's last shot before this one
+    int ship;     // ship hit, NO_SHIP if shot missed
+} shotRecord;
+
+// index of cell x, y on player's board, x and y from 1
+// same as bbIndex() on 10 x 10 boards
+static inline int cellIndex(player *p, int x, int y)
+{
+    return (y - 1) * p->width + (x - 1);
+}
+
+// player's shot at cell of opponent's board, 0 if not shot, SHOT_MISS or SHOT_HIT
+static inline int shotAt(player *p, int cell)
+{
+    return p->sparse ? cellMapGet(&p->shotMap, cell, 0) : p->shots[cell];
+}
+
+// ship occupying cell of player's board, NO_SHIP if empty
+static inline int shipAtCell(player *p, int cell)
+{
+    return p->sparse ? cellMapGet(&p->shipMap, cell, NO_SHIP) : p->shipAt[cell];
+}
 
 const char *message(int msg);
+void setMessage(player *p, int msg);
 
 /* Game Mechanics
 **********************************************************************
@@ -53,10 +107,15 @@ const char *message(int msg);
 
 /* Ship Placement
 *********************************************************************/
-int getRotation(int rotation);
+void shipDirection(int rotation, int *dx, int *dy);
+bool shipMask(int len, int center, int x, int y, int rotation, bitboard *mask);
+bool shipFits(player *p, ship *s, int x, int y, int rotation);
+void removeShip(player *p, ship *s);
+int addShip(player *p, ship *s, int x, int y);
+void initialShipPos(player *p, ship *s, int *x, int *y);
+void updateShipPos(player *p, ship *s);
 bool checkCells(player *p, int *x, int *y, int *rotation, int placing);
 void rotateShip(player *p, int rotation);
-void placeShips(player *p);
 void clearSelectedShip(player *p);
 int placeSelectedShip(player *p, int x, int y);
 int setSelectedShip(bool started, player *p, int selectedShip);
@@ -66,9 +125,18 @@ int setSelectedShip(bool started, player *p, int selectedShip);
 *********************************************************************/
 int checkSunk(player *p2, player *p1, int x, int y);
 int checkGameOver(player *p);
+int fireAt(player *p1, player *p2, bool *running, int x, int y);
+int recordShot(player *p1, player *p2, bool *running, int x, int y, int result);
 int takeShot(player *p1, player *p2, bool *running, int x, int y);
 /********************************************************************/
 
+/* Search
+    shots w/o messages or display, for trying shots and taking them back
+*********************************************************************/
+int makeShotAt(player *p1, player *p2, int cell, shotRecord *r);
+void unmakeShotAt(player *p1, player *p2, const shotRecord *r);
+/********************************************************************/
+
 /*********************************************************************
 *********************************************************************/
 
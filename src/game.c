@@ -0,0 +1,597 @@
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+
+/* Initialization
+**********************************************************************
+*********************************************************************/
+
+// clear player's shots and ships off board
+void initializeBoards(player *p)
+{
+    // clear board layers
+    p->fleet = bbEmpty();
+    p->hits = bbEmpty();
+    p->misses = bbEmpty();
+    if (p->sparse)
+    {
+        clearCellMap(&p->shotMap);
+        clearCellMap(&p->shipMap);
+    }
+    else
+    {
+        for (int i = 0; i < p->width * p->height; i++)
+        {
+            p->shots[i] = 0;
+            p->shipAt[i] = NO_SHIP;
+        }
+    }
+    p->shotsTaken = 0;
+    p->lastShot = -1;
+
+    p->dirty = true; // board needs to be drawn
+}
+
+// set default values and positions for player's ships
+void initializeShips(player *p, const rules *r)
+{
+    ship s = {0};
+
+    for (int i = 0; i < r->nships; i++)
+    {
+        p->ships[i] = s;                          // empty ship struct
+        p->ships[i].len = r->lens[i];             // carrier, cruiser, destroyer, submarine and patrol boat in standard fleet
+        p->ships[i].rot = 0;                      // initial orientation left
+        p->ships[i].isPlaced = false;             // ships not placed on board yet
+        p->ships[i].sunk = false;                 // no ships sunk yet
+        p->ships[i].hitCount = 0;
+        p->ships[i].cells[0] = -1;                // ships not on board yet
+        p->ships[i].mask = bbEmpty();
+        p->ships[i].center = p->ships[i].len / 2; // calculate ship's center point
+
+        // place ships to right of player board
+        initialShipPos(p, &p->ships[i], &p->ships[i].x, &p->ships[i].y);
+    }
+    p->dirty = true;
+
+    p->nships = r->nships;
+    p->selectedShip = -1;       // no ship selected yet
+    p->shipsAfloat = r->nships; // every ship afloat
+}
+
+// bytes of storage both players' board arrays and fleets take w/ given rules
+// sparse boards keep their cells in cell maps, so only their fleets are stored
+size_t gameStorageSize(const rules *r)
+{
+    size_t cells = sparseRules(r) ? 0 : (size_t)r->width * r->height;
+
+    return 2 * (r->nships * sizeof(ship) + cells * (sizeof(short) + 1));
+}
+
+// set up game's cell maps and storage before its first initializeGame()
+// tail is size bytes after game in its own block or pool slot for storage, NULL if none
+void initializeGameStorage(game *g, void *tail, size_t size)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        initializeCellMap(&g->players[i].shotMap);
+        initializeCellMap(&g->players[i].shipMap);
+    }
+    g->storage = tail;
+    g->storageSize = (tail != NULL) ? size : 0;
+    g->ownsStorage = false;
+}
+
+// release memory game's cell maps grew and storage allocated for rules its tail didn't fit
+void freeGameStorage(game *g)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        freeCellMap(&g->players[i].shotMap);
+        freeCellMap(&g->players[i].shipMap);
+    }
+    if (g->ownsStorage)
+        free(g->storage);
+    g->storage = NULL;
+    g->storageSize = 0;
+    g->ownsStorage = false;
+}
+
+// grow game's storage to at least size bytes, keeping nothing stored in it
+// returns 0 on success, 1 if memory ran out
+int reserveGameStorage(game *g, size_t size)
+{
+    unsigned char *storage;
+
+    if (size <= g->storageSize)
+        return 0;
+    storage = malloc(size);
+    if (storage == NULL)
+        return 1;
+    if (g->ownsStorage)
+        free(g->storage);
+    g->storage = storage;
+    g->storageSize = size;
+    g->ownsStorage = true;
+    return 0;
+}
+
+// point players' board arrays and fleets into game's storage, laid out for game's rules
+// fleets come first, so every array is aligned for its type
+void layoutGame(game *g)
+{
+    size_t cells = sparseRules(&g->rules) ? 0 : (size_t)g->rules.width * g->rules.height;
+    unsigned char *next = g->storage;
+
+    for (int i = 0; i < 2; i++, next += g->rules.nships * sizeof(ship))
+        g->players[i].ships = (ship *)next;
+    for (int i = 0; i < 2; i++, next += cells * sizeof(short))
+        g->players[i].shipAt = (short *)next;
+    for (int i = 0; i < 2; i++, next += cells)
+        g->players[i].shots = next;
+}
+
+// reset both players and game state w/ given rules, no ships placed on board
+// rules must be valid, see checkRules(), and game's storage set up, see initializeGameStorage()
+// storage only grows if rules need more than game has, so replaying rules a game was set up for allocates nothing
+// returns 0 on success, 1 if memory ran out
+int initializeGame(game *g, const rules *r)
+{
+    player *p;
+
+    if (reserveGameStorage(g, gameStorageSize(r)))
+        return 1;
+
+    g->rules = *r;
+    layoutGame(g);
+    for (int i = 0; i < 2; i++)
+    {
+        p = &g->players[i];
+        p->width = r->width;
+        p->height = r->height;
+        p->bitboards = bitboardRules(r);
+        p->sparse = sparseRules(r);
+
+        initializeBoards(p);
+        initializeShips(p, r);
+        setStrategy(g, i, &huntStrategy);
+        setMessage(p, 12); // place your ships msg
+        p->pause = false;
+    }
+
+    g->turn = 0;
+    g->running = true;
+    g->started = false;
+    return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
+
+/* Game Logic
+**********************************************************************
+*********************************************************************/
+
+// start game if all ships are placed on board
+int startGame(player *p, bool *started)
+{
+    *started = true;
+    for (int i = 0; i < p->nships; i++)
+    {
+        // check if ship is placed
+        if (!p->ships[i].isPlaced)
+        {
+            *started = false;
+            setMessage(p, 1); // place all ships to start game msg
+            p->pause = true;
+            return 1;
+        }
+    }
+    p->selectedShip = -1; // ships cannot be selected after game has started
+    setMessage(p, 0);     // game started msg
+    return 0;
+}
+
+/*********************************************************************
+*********************************************************************/
+
+/* Headless Game API
+**********************************************************************
+*********************************************************************/
+
+// allocate and initialize a new game w/ given rules, standard rules if NULL
+// game and storage for its rules are one block, bigger rules given to initializeGame() later allocate more
+// returns NULL if rules are invalid or memory ran out
+game *createGame(const rules *r)
+{
+    size_t size;
+    game *g;
+
+    if (r == NULL)
+        r = &standardRules;
+    if (checkRules(r))
+        return NULL;
+
+    size = gameStorageSize(r);
+    g = malloc(sizeof(game) + size);
+    if (g == NULL)
+        return NULL;
+    initializeGameStorage(g, g + 1, size);
+    initializeGame(g, r); // fits in block
+    seedGame(g, 0);
+    return g;
+}
+
+// release game allocated w/ createGame()
+void destroyGame(game *g)
+{
+    freeGameStorage(g);
+    free(g);
+}
+
+// seed random choices of both computer players
+// games w/ the same seed and moves play out the same
+void seedGame(game *g, uint64_t seed)
+{
+    rng r;
+
+    g->seed = seed;
+    rngSeed(&r, seed);
+    for (int i = 0; i < 2; i++)
+        rngSeed(&g->guesses[i].rng, rngNext(&r));
+}
+
+// choose strategy computerShot() uses for player, resets player's computer shooting state
+void setStrategy(game *g, int p, const strategy *st)
+{
+    g->strategies[p] = st;
+    st->init(&g->guesses[p]);
+}
+
+// place one of player's ships w/ its center at x, y on player's board
+// returns 0 if placed, 1 if ship can't be placed there, ship keeps its previous placement
+int placeShip(game *g, int p, int shipNum, int x, int y, int rotation)
+{
+    player *pl = &g->players[p];
+    ship *s;
+
+    if (g->started || shipNum < 0 || shipNum >= pl->nships || rotation < 0 || rotation > 3)
+        return 1;
+    s = &pl->ships[shipNum];
+    if (!shipFits(pl, s, x, y, rotation))
+        return 1;
+
+    removeShip(pl, s);
+    s->rot = rotation;
+    s->isPlaced = !addShip(pl, s, x, y);
+    updateShipPos(pl, s);
+    return !s->isPlaced;
+}
+
+// place all of player's ships at random locations w/ random rotations
+// returns 0 if placed, 1 if a ship didn't fit around ships placed before it
+int placeRandomFleet(game *g, int p)
+{
+    return initializeOpponent(&g->players[p], &g->guesses[p]);
+}
+
+// start game once both players' fleets are placed
+// returns 0 if started, 1 if a fleet is not fully placed
+int beginGame(game *g)
+{
+    bool started;
+
+    if (startGame(&g->players[0], &started) || startGame(&g->players[1], &started))
+        return 1;
+    g->started = true;
+    return 0;
+}
+
+// player whose turn it is shoots at x, y on opponent's board
+// returns 0 if shot not taken, 1 for miss, 2 for hit, 3 for hit that sank a ship
+int fireShot(game *g, int x, int y)
+{
+    int result;
+
+    if (!g->started || !g->running)
+        return 0;
+
+    result = fireAt(&g->players[g->turn % 2], &g->players[(g->turn + 1) % 2], &g->running, x, y);
+    if (result != 0)
+        g->turn++;
+    return result;
+}
+
+// player whose turn it is shoots using its strategy
+// returns same results as fireShot()
+int computerShot(game *g)
+{
+    int shooter = g->turn % 2, result;
+
+    if (!g->started || !g->running)
+        return 0;
+
+    result = strategyShot(g->strategies[shooter], &g->players[(shooter + 1) % 2], &g->players[shooter], &g->running, &g->guesses[shooter]);
+    if (result != 0)
+        g->turn++;
+    return result;
+}
+
+// state of cell at x, y on player's board
+// 0 for empty, 1 for ship, 2 for opponent's miss, 3 for opponent's hit
+int cellState(game *g, int p, int x, int y)
+{
+    player *pl = &g->players[p], *opponent = &g->players[(p + 1) % 2];
+    int cell;
+
+    if (x > pl->width || x < 1 || y > pl->height || y < 1)
+        return 0;
+
+    cell = cellIndex(pl, x, y);
+    if (shotAt(opponent, cell) == SHOT_HIT)
+        return 3;
+    if (shotAt(opponent, cell) == SHOT_MISS)
+        return 2;
+    return shipAtCell(pl, cell) != NO_SHIP;
+}
+
+// number of player's ships not yet sunk
+int shipsRemaining(game *g, int p)
+{
+    return g->players[p].shipsAfloat;
+}
+
+// player number of winner, -1 if game is not over
+int gameWinner(game *g)
+{
+    if (!g->started)
+        return -1;
+    if (checkGameOver(&g->players[1]))
+        return 0;
+    if (checkGameOver(&g->players[0]))
+        return 1;
+    return -1;
+}
+
+/*********************************************************************
+*********************************************************************/
+/* Game Pools
+**********************************************************************
+*********************************************************************/
+
+// allocate pool of capacity games for acquireGame(), each slot w/ storage for given rules, standard rules if NULL
+// games are set up the first time they're acquired, so pages of games never used aren't touched
+// returns 0 on success, 1 if memory ran out
+int initializeGamePool(pool *p, long capacity, const rules *r)
+{
+    return initializePool(p, sizeof(game) + gameStorageSize((r != NULL) ? r : &standardRules), capacity);
+}
+
+// release pool and memory its games' cell maps grew
+void freeGamePool(pool *p)
+{
+    for (long i = 0; i < p->touched; i++)
+        freeGameStorage(poolSlot(p, i));
+    freePool(p);
+}
+
+// take a game from pool and initialize it like createGame() w/ given rules, standard rules if NULL
+// games keep their cell maps' memory between uses, so acquiring and playing games allocates nothing
+// except while sparse boards grow cell maps bigger than any earlier game needed, or rules need more storage than pool's
+// returns NULL if rules are invalid, memory ran out or every game of pool is in use
+game *acquireGame(pool *p, const rules *r)
+{
+    long touched = p->touched;
+    game *g;
+
+    if (r == NULL)
+        r = &standardRules;
+    if (checkRules(r))
+        return NULL;
+
+    g = acquireSlot(p);
+    if (g != NULL)
+    {
+        if (slotIndex(p, g) >= touched)
+            initializeGameStorage(g, g + 1, p->size - sizeof(game));
+        if (initializeGame(g, r))
+        {
+            releaseSlot(p, g);
+            return NULL;
+        }
+        seedGame(g, 0);
+    }
+    return g;
+}
+
+// return game from acquireGame() to its pool
+void releaseGame(pool *p, game *g)
+{
+    releaseSlot(p, g);
+}
+
+/*********************************************************************
+*********************************************************************/
+/* Search
+**********************************************************************
+*********************************************************************/
+
+// allocate stack for up to capacity shots
+// returns 0 on success, 1 if memory ran out
+int initializeUndoStack(undoStack *u, int capacity)
+{
+    u->shots = malloc(capacity * sizeof(shotRecord));
+    u->count = 0;
+    u->capacity = (u->shots != NULL) ? capacity : 0;
+    return u->shots == NULL;
+}
+
+void freeUndoStack(undoStack *u)
+{
+    free(u->shots);
+    u->shots = NULL;
+    u->count = 0;
+    u->capacity = 0;
+}
+
+// copy whole game, messages included, into dst set up w/ initializeGameStorage()
+// dst keeps its own storage and cell maps, storage grows if src's rules need more
+// returns 0 on success, 1 if src's rules are sparse, since its cell maps aren't copied, or memory ran out
+int copyGame(game *dst, const game *src)
+{
+    unsigned char *storage;
+    size_t storageSize;
+    bool ownsStorage;
+    cellMap shotMaps[2], shipMaps[2];
+
+    if (dst == src)
+        return 0;
+    if (src->players[0].sparse || reserveGameStorage(dst, gameStorageSize(&src->rules)))
+        return 1;
+
+    storage = dst->storage;
+    storageSize = dst->storageSize;
+    ownsStorage = dst->ownsStorage;
+    for (int i = 0; i < 2; i++)
+    {
+        shotMaps[i] = dst->players[i].shotMap;
+        shipMaps[i] = dst->players[i].shipMap;
+    }
+
+    memcpy(dst, src, sizeof(game));
+
+    dst->storage = storage;
+    dst->storageSize = storageSize;
+    dst->ownsStorage = ownsStorage;
+    for (int i = 0; i < 2; i++)
+    {
+        dst->players[i].shotMap = shotMaps[i];
+        dst->players[i].shipMap = shipMaps[i];
+    }
+    layoutGame(dst);
+    memcpy(dst->storage, src->storage, gameStorageSize(&src->rules));
+    return 0;
+}
+
+// bytes of fleet lengths after fixed part of a snapshot, padded so game's storage after them stays aligned
+size_t snapshotLensSize(const rules *r)
+{
+    return (r->nships + 7) / 8 * 8;
+}
+
+// bytes a snapshot of a game w/ given rules takes
+size_t snapshotSize(const rules *r)
+{
+    return sizeof(gameSnapshot) + snapshotLensSize(r) + gameStorageSize(r);
+}
+
+// save game state to snapshot, snapshotSize() bytes aligned like malloc() memory
+// only cells and ships in use are saved, so it's cheap enough to snapshot every node of a search
+// returns 0 on success, 1 if game's rules are sparse
+int snapshotGame(const game *g, void *snapshot)
+{
+    gameSnapshot *s = snapshot;
+    unsigned char *lens = (unsigned char *)(s + 1);
+
+    if (g->players[0].sparse)
+        return 1;
+
+    s->width = g->rules.width;
+    s->height = g->rules.height;
+    s->nships = g->rules.nships;
+    s->turn = g->turn;
+    s->running = g->running;
+    s->started = g->started;
+    s->seed = g->seed;
+    for (int i = 0; i < 2; i++)
+    {
+        s->strategies[i] = g->strategies[i];
+        s->guesses[i] = g->guesses[i];
+        s->players[i].fleet = g->players[i].fleet;
+        s->players[i].hits = g->players[i].hits;
+        s->players[i].misses = g->players[i].misses;
+        s->players[i].shotsTaken = g->players[i].shotsTaken;
+        s->players[i].lastShot = g->players[i].lastShot;
+        s->players[i].shipsAfloat = g->players[i].shipsAfloat;
+    }
+    memcpy(lens, g->rules.lens, g->rules.nships);
+    memcpy(lens + snapshotLensSize(&g->rules), g->storage, gameStorageSize(&g->rules));
+    return 0;
+}
+
+// put game back in state saved to snapshot w/ snapshotGame()
+// game must have same rules as game snapshot was taken of, its messages are left as they are
+// returns 0 on success, 1 if rules are sparse or board or fleet differ
+int restoreGame(game *g, const void *snapshot)
+{
+    const gameSnapshot *s = snapshot;
+    const unsigned char *lens = (const unsigned char *)(s + 1);
+
+    if (g->players[0].sparse || s->width != g->rules.width || s->height != g->rules.height || s->nships != g->rules.nships ||
+        memcmp(lens, g->rules.lens, g->rules.nships))
+        return 1;
+
+    g->turn = s->turn;
+    g->running = s->running;
+    g->started = s->started;
+    g->seed = s->seed;
+    for (int i = 0; i < 2; i++)
+    {
+        g->strategies[i] = s->strategies[i];
+        g->guesses[i] = s->guesses[i];
+        g->players[i].fleet = s->players[i].fleet;
+        g->players[i].hits = s->players[i].hits;
+        g->players[i].misses = s->players[i].misses;
+        g->players[i].shotsTaken = s->players[i].shotsTaken;
+        g->players[i].lastShot = s->players[i].lastShot;
+        g->players[i].shipsAfloat = s->players[i].shipsAfloat;
+    }
+    memcpy(g->storage, lens + snapshotLensSize(&g->rules), gameStorageSize(&g->rules));
+    return 0;
+}
+
+// player whose turn it is shoots at x, y on opponent's board and pushes what changed onto u
+// unlike fireShot(), messages and computer players' state are left alone
+// returns same results as fireShot(), 0 also if u is full
+int makeShot(game *g, undoStack *u, int x, int y)
+{
+    int shooter = g->turn % 2, result;
+    player *target = &g->players[!shooter];
+
+    if (!g->started || !g->running || u->count == u->capacity || x > target->width || x < 1 || y > target->height || y < 1)
+        return 0;
+
+    result = makeShotAt(&g->players[shooter], target, cellIndex(target, x, y), &u->shots[u->count]);
+    if (result == 0)
+        return 0;
+    u->count++;
+    g->turn++;
+    if (checkGameOver(target))
+        g->running = false;
+    return result;
+}
+
+// take back last shot pushed onto u, every shot since it must have been made w/ makeShot()
+// returns 0 on success, 1 if u is empty
+int unmakeShot(game *g, undoStack *u)
+{
+    int shooter;
+
+    if (u->count == 0)
+        return 1;
+    g->turn--;
+    shooter = g->turn % 2;
+    unmakeShotAt(&g->players[shooter], &g->players[!shooter], &u->shots[--u->count]);
+    g->running = true; // shots are only made while game is running
+    return 0;
+}
+
+// take back shots until u holds mark shots, mark is u->count when position was saved
+void rewindGame(game *g, undoStack *u, int mark)
+{
+    while (u->count > mark)
+        unmakeShot(g, u);
+}
+
+/*********************************************************************
+*********************************************************************/
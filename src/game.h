@@ -0,0 +1,115 @@
+#ifndef __GAME_H__
+#define __GAME_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "engine.h"
+#include "opponent.h"
+#include "pool.h"
+#include "rules.h"
+#include "strategy.h"
+
+// state of a game between two players
+// players[0] shoots on even turns and players[1] on odd turns
+// players' board arrays and fleets live in storage sized from rules, so copy games w/ copyGame()
+typedef struct
+{
+    player players[2];
+    opponentGuess guesses[2];      // computer shooting state for each player
+    const strategy *strategies[2]; // computer shooting strategy for each player, see strategy.h
+    rules rules;                   // board size and fleet both players use
+    uint64_t seed;                 // seed of computer players' random choices, see seedGame()
+    int turn;
+    bool running, started;
+
+    // board arrays and fleets of both players, see layoutGame()
+    unsigned char *storage;
+    size_t storageSize; // bytes of storage, at least gameStorageSize() of rules
+    bool ownsStorage;   // storage was allocated for rules that didn't fit, otherwise it's in game's block or pool slot
+} game;
+
+// fixed part of a snapshot of a game, see snapshotGame()
+// followed by fleet lengths and game's storage, so a snapshot takes snapshotSize() of game's rules
+// messages and ship selection aren't saved
+typedef struct
+{
+    int width, height, nships; // rules of game snapshot was taken of
+    int turn;
+    bool running, started;
+    uint64_t seed;
+    const strategy *strategies[2];
+    opponentGuess guesses[2];
+    struct
+    {
+        bitboard fleet, hits, misses;
+        int shotsTaken, lastShot, shipsAfloat;
+    } players[2];
+} gameSnapshot;
+
+// shots made w/ makeShot(), last one on top, so they can be taken back
+typedef struct
+{
+    shotRecord *shots;
+    int count, capacity;
+} undoStack;
+
+/* Initialization
+*********************************************************************/
+void initializeBoards(player *p);
+void initializeShips(player *p, const rules *r);
+size_t gameStorageSize(const rules *r);
+void initializeGameStorage(game *g, void *tail, size_t size);
+void freeGameStorage(game *g);
+int reserveGameStorage(game *g, size_t size);
+void layoutGame(game *g);
+int initializeGame(game *g, const rules *r);
+/********************************************************************/
+
+/* Game Logic
+*********************************************************************/
+int startGame(player *p, bool *started);
+/********************************************************************/
+
+/* Headless Game API
+    player numbers are 0 or 1, board coordinates are 1 - width and 1 - height of rules
+*********************************************************************/
+game *createGame(const rules *r);
+void destroyGame(game *g);
+void seedGame(game *g, uint64_t seed);
+void setStrategy(game *g, int p, const strategy *st);
+int placeShip(game *g, int p, int shipNum, int x, int y, int rotation);
+int placeRandomFleet(game *g, int p);
+int beginGame(game *g);
+int fireShot(game *g, int x, int y);
+int computerShot(game *g);
+int cellState(game *g, int p, int x, int y);
+int shipsRemaining(game *g, int p);
+int gameWinner(game *g);
+/********************************************************************/
+
+/* Game Pools
+    fixed capacity arenas of games, for hosting many games w/o allocating per game
+*********************************************************************/
+int initializeGamePool(pool *p, long capacity, const rules *r);
+void freeGamePool(pool *p);
+game *acquireGame(pool *p, const rules *r);
+void releaseGame(pool *p, game *g);
+/********************************************************************/
+
+/* Search
+    trying shots and taking them back, for computer players that look ahead
+*********************************************************************/
+int initializeUndoStack(undoStack *u, int capacity);
+void freeUndoStack(undoStack *u);
+int copyGame(game *dst, const game *src);
+size_t snapshotLensSize(const rules *r);
+size_t snapshotSize(const rules *r);
+int snapshotGame(const game *g, void *snapshot);
+int restoreGame(game *g, const void *snapshot);
+int makeShot(game *g, undoStack *u, int x, int y);
+int unmakeShot(game *g, undoStack *u);
+void rewindGame(game *g, undoStack *u, int mark);
+/********************************************************************/
+
+#endif
@@ -0,0 +1,98 @@
+/*
+Battleship network player
+
+Plays a network game w/ a computer player and no rendering, as host or client,
+against another battleship-net or the SDL game. Fleets are placed at random.
+
+Usage: battleship-net host [port] [strategy] [rules] [seed]
+       battleship-net join [address] [port] [strategy] [seed]
+strategy is random, hunt (default), parity or density
+rules choose board size and fleet the host plays, see parseRules(), like 20x20
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game.h"
+#include "network.h"
+
+#define POLL_MS 100 // longest wait for peer before pinging or checking session again
+
+int main(int argc, char *argv[])
+{
+    bool host = argc > 1 && !strcmp(argv[1], "host");
+    int arg = host ? 2 : 3; // first argument after address
+    const char *address = (!host && argc > 2) ? argv[2] : "localhost";
+    int port = (argc > arg) ? atoi(argv[arg]) : NET_PORT;
+    const strategy *st = (argc > arg + 1) ? findStrategy(argv[arg + 1]) : &huntStrategy;
+    uint64_t seed = (argc > arg + 2 + host) ? strtoull(argv[arg + 2 + host], NULL, 0) : (uint64_t)time(NULL);
+    rules r = standardRules;
+    struct pollfd pfd;
+    netSession *n = malloc(sizeof(netSession));
+    game *g;
+    int winner;
+
+    if (argc < 2 || (!host && strcmp(argv[1], "join")) || port < 1 || st == NULL || (host && argc > 4 && parseRules(argv[4], &r)))
+    {
+        printf("Usage: %s host [port] [strategy] [rules] [seed]\n", argv[0]);
+        printf("       %s join [address] [port] [strategy] [seed]\n", argv[0]);
+        printf("strategies: random, hunt, parity, density\n");
+        return 1;
+    }
+    g = createGame(&r);
+    if (n == NULL || g == NULL)
+        return 1;
+    seedGame(g, seed);
+
+    if (host ? hostSession(n, port, false) : joinSession(n, address, port, false))
+    {
+        if (host)
+            printf("Can't listen on port %d\n", port);
+        else
+            printf("Can't connect to %s port %d\n", address, port);
+        return 1;
+    }
+    n->strategy = st;
+    if (host)
+        printf("Waiting for opponent on port %d\n", port);
+
+    // host keeps session open until client has read the end of game and closes
+    while (sessionSocket(n) >= 0 && !(!host && n->state == NET_OVER))
+    {
+        pfd.fd = sessionSocket(n);
+        pfd.events = POLLIN;
+        poll(&pfd, 1, localTurn(n, g) ? 0 : POLL_MS);
+
+        if (pollSession(n, g))
+            break;
+        if (n->state == NET_PLACING && !n->localReady && (placeRandomFleet(g, 0) || commitFleet(n, g)))
+        {
+            printf("Fleet doesn't fit on board\n");
+            closeSession(n, NET_RULES);
+            break;
+        }
+        if (localTurn(n, g))
+            sendComputerShot(n, g);
+    }
+    closeSession(n, NET_OK);
+
+    if (n->error != NET_OK)
+    {
+        printf("Game ended: %s\n", sessionError(n->error));
+        return 1;
+    }
+
+    winner = gameWinner(g);
+    printf("board      %dx%d, %d ships\n", g->rules.width, g->rules.height, g->rules.nships);
+    printf("result     %s, %d shots\n", (winner == 0) ? "won" : (winner == 1) ? "lost" : "unfinished", g->players[0].shotsTaken);
+    if (n->trips)
+        printf("round trip %.3f ms average, %.3f ms min, %.3f ms max over %ld trips\n", 1e3 * n->rttTotal / n->trips, 1e3 * n->rttMin, 1e3 * n->rttMax, n->trips);
+
+    free(n);
+    destroyGame(g);
+    return 0;
+}
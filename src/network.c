@@ -0,0 +1,770 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#define close closesocket
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#include "network.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // platforms w/o it set SO_NOSIGPIPE on socket instead, see setNonBlocking()
+#endif
+
+/* Sockets
+*********************************************************************/
+// set socket to return at once instead of blocking, and to send small messages w/o delay
+// returns 0 on success, 1 if socket can't be set non-blocking
+int setNonBlocking(int sock)
+{
+    int one = 1;
+#ifdef _WIN32
+    u_long mode = 1;
+
+    if (ioctlsocket(sock, FIONBIO, &mode))
+        return 1;
+#else
+    int flags = fcntl(sock, F_GETFL, 0);
+
+    if (flags < 0 || fcntl(sock, F_SETFL, flags | O_NONBLOCK) < 0)
+        return 1;
+#endif
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+    setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+    return 0;
+}
+
+// last socket call failed only because it would have blocked
+bool wouldBlock(void)
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// send as much of out buffer as socket takes w/o blocking
+void flushSession(netSession *n)
+{
+    long sent;
+    size_t done = 0;
+
+    while (n->sock >= 0 && done < n->outLen)
+    {
+        sent = send(n->sock, (const char *)n->out + done, n->outLen - done, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (!wouldBlock())
+                closeSession(n, NET_DISCONNECTED);
+            break;
+        }
+        done += sent;
+    }
+    memmove(n->out, n->out + done, n->outLen - done);
+    n->outLen -= (done < n->outLen) ? done : n->outLen;
+}
+/********************************************************************/
+
+/* Messages
+*********************************************************************/
+// append bytes to out buffer, closes session if peer has stopped reading
+void putBytes(netSession *n, const void *bytes, size_t len)
+{
+    if (n->outLen + len > NET_BUFFER_SIZE)
+    {
+        closeSession(n, NET_DISCONNECTED);
+        return;
+    }
+    memcpy(n->out + n->outLen, bytes, len);
+    n->outLen += len;
+}
+
+// append little endian integer of given bytes
+void putInt(netSession *n, uint64_t value, int bytes)
+{
+    unsigned char buf[8];
+
+    for (int i = 0; i < bytes; i++)
+        buf[i] = value >> (8 * i);
+    putBytes(n, buf, bytes);
+}
+
+// little endian integer of given bytes at p
+uint64_t getInt(const unsigned char *p, int bytes)
+{
+    uint64_t value = 0;
+
+    for (int i = 0; i < bytes; i++)
+        value |= (uint64_t)p[i] << (8 * i);
+    return value;
+}
+
+// cell at p, -1 if it's not on board of game
+int getCell(game *g, const unsigned char *p)
+{
+    uint64_t cell = getInt(p, 4);
+
+    return (cell < g->rules.width * g->rules.height) ? cell : -1;
+}
+
+// FNV-1a hash of salt and fleet bytes
+// not cryptographic, a commitment keeps honest hosts honest rather than stopping a determined cheat
+uint64_t hashFleet(uint64_t salt, const unsigned char *fleet, size_t len)
+{
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (int i = 0; i < 8; i++)
+        hash = (hash ^ ((salt >> (8 * i)) & 0xFF)) * 0x100000001B3ull;
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ fleet[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+// center cell and rotation of each of player's ships, as sent in FLEET and REVEAL
+void fleetBytes(player *p, unsigned char *fleet)
+{
+    ship *s;
+    int cell;
+
+    for (int i = 0; i < p->nships; i++, fleet += NET_FLEET_BYTES)
+    {
+        s = &p->ships[i];
+        cell = s->cells[s->center];
+        for (int j = 0; j < 4; j++)
+            fleet[j] = cell >> (8 * j);
+        fleet[4] = s->rot;
+    }
+}
+
+// bytes of message starting at p w/ avail bytes buffered
+// returns 0 if more bytes are needed to tell, -1 if message type is unknown
+long messageLength(game *g, const unsigned char *p, size_t avail)
+{
+    switch (p[0])
+    {
+    case 'H':
+        return (avail < 12) ? 0 : 13 + (long)getInt(p + 10, 2);
+    case 'F':
+        return 1 + NET_FLEET_BYTES * g->rules.nships;
+    case 'R':
+    case 'P':
+    case 'Q':
+        return 9;
+    case 'S':
+        return 5;
+    case 'X':
+        return (avail < 7) ? 0 : (p[6] == 3) ? 14 : 7;
+    case 'V':
+        return 9 + NET_FLEET_BYTES * g->rules.nships;
+    case 'E':
+        return 2;
+    }
+    return -1;
+}
+
+// queue result of a shot host's engine resolved, and host's fleet if game is over
+void sendResult(netSession *n, game *g, int shooter, int result)
+{
+    player *target = &g->players[(shooter + 1) % 2];
+    unsigned char fleet[NET_FLEET_BYTES * MAX_SHIPS];
+    int cell = g->players[shooter].lastShot;
+    ship *s;
+
+    putInt(n, 'X', 1);
+    putInt(n, shooter, 1);
+    putInt(n, cell, 4);
+    putInt(n, result, 1);
+    if (result == 3)
+    {
+        s = &target->ships[shipAtCell(target, cell)];
+        putInt(n, s - target->ships, 2);
+        putInt(n, s->cells[s->center], 4);
+        putInt(n, s->rot, 1);
+    }
+
+    if (!g->running)
+    {
+        fleetBytes(&g->players[0], fleet);
+        putInt(n, 'V', 1);
+        putInt(n, n->salt, 8);
+        putBytes(n, fleet, NET_FLEET_BYTES * g->rules.nships);
+        n->state = NET_OVER;
+    }
+}
+
+// host starts game once both fleets are placed
+void tryStart(netSession *n, game *g)
+{
+    if (!n->localReady || !n->peerReady || beginGame(g))
+        return;
+    putInt(n, 'R', 1);
+    putInt(n, n->commit, 8);
+    n->state = NET_PLAYING;
+    if (n->strategy != NULL)
+        n->strategy->init(&g->guesses[0]);
+}
+
+// client plays rules host sent, resetting game only if they changed
+// returns NET_OK, or reason to close session
+int readHello(netSession *n, game *g, const unsigned char *p)
+{
+    rules r;
+
+    if (memcmp(p + 1, NET_MAGIC, 4) || p[5] != NET_VERSION)
+        return NET_PROTOCOL;
+    r.width = getInt(p + 6, 2);
+    r.height = getInt(p + 8, 2);
+    r.nships = getInt(p + 10, 2);
+    if (r.nships > MAX_SHIPS)
+        return NET_RULES;
+    for (int i = 0; i < r.nships; i++)
+        r.lens[i] = p[12 + i];
+    n->first = p[12 + r.nships];
+
+    if (checkRules(&r) || (n->display && !displayRules(&r)))
+        return NET_RULES;
+    if (r.width != g->rules.width || r.height != g->rules.height || r.nships != g->rules.nships ||
+        memcmp(r.lens, g->rules.lens, r.nships))
+    {
+        if (initializeGame(g, &r))
+            return NET_RULES;
+    }
+    n->state = NET_PLACING;
+    return NET_OK;
+}
+
+// host places client's fleet on players[1]
+// returns NET_OK, or reason to close session
+int readFleet(netSession *n, game *g, const unsigned char *p)
+{
+    int cell;
+
+    p++;
+    for (int i = 0; i < g->rules.nships; i++, p += NET_FLEET_BYTES)
+    {
+        cell = getCell(g, p);
+        if (cell < 0 || placeShip(g, 1, i, cell % g->rules.width + 1, cell / g->rules.width + 1, p[4]))
+            return NET_PROTOCOL;
+    }
+    n->peerReady = true;
+    tryStart(n, g);
+    return NET_OK;
+}
+
+// put ship of host's fleet on client's copy of host's board at cell and rotation
+// returns 0 on success, 1 if it doesn't fit around ships already there
+int placeRevealed(player *p, ship *s, int cell, int rot)
+{
+    int x = cell % p->width + 1, y = cell / p->width + 1;
+
+    if (rot > 3 || cell < 0 || !shipFits(p, s, x, y, rot))
+        return 1;
+    s->rot = rot;
+    if (addShip(p, s, x, y))
+        return 1;
+    s->isPlaced = true;
+    updateShipPos(p, s);
+    return 0;
+}
+
+// client applies host's result of a shot by either player
+// returns NET_OK, or reason to close session
+int readResult(netSession *n, game *g, const unsigned char *p)
+{
+    player *local = &g->players[0], *remote = &g->players[1];
+    int shooter = p[1], cell = getCell(g, p + 2), result = p[6], id, x, y;
+    ship *s;
+
+    if (cell < 0)
+        return NET_PROTOCOL;
+    x = cell % g->rules.width + 1;
+    y = cell / g->rules.width + 1;
+
+    // host's shot at client's fleet, client's engine must come to the same result
+    if (shooter == 0)
+    {
+        if (g->turn % 2 != 1 || !g->running)
+            return NET_PROTOCOL;
+        if (fireShot(g, x, y) != result || (result == 3 && shipAtCell(local, cell) != getInt(p + 7, 2)))
+            return NET_DESYNC;
+        return NET_OK;
+    }
+
+    // result of client's shot, host's ship is revealed once it sinks
+    if (shooter != 1 || !n->waiting || x != n->pendingX || y != n->pendingY)
+        return NET_PROTOCOL;
+    if (result == 3)
+    {
+        id = getInt(p + 7, 2);
+        if (id >= remote->nships || remote->ships[id].sunk || placeRevealed(remote, &remote->ships[id], getCell(g, p + 9), p[13]))
+            return NET_PROTOCOL;
+        s = &remote->ships[id];
+        s->sunk = true;
+        s->hitCount = s->len;
+    }
+    if (!recordShot(local, remote, &g->running, x, y, result))
+        return NET_PROTOCOL;
+    g->turn++;
+    n->waiting = false;
+    countRoundTrip(n, n->shotSent);
+    if (n->strategy != NULL)
+        n->strategy->observe(remote, local, &g->guesses[0], x, y, result);
+    return NET_OK;
+}
+
+// client checks host's revealed fleet against its commitment and every result host gave
+// returns NET_OK, or reason to close session
+int readReveal(netSession *n, game *g, const unsigned char *p)
+{
+    player *local = &g->players[0], *remote = &g->players[1];
+    const unsigned char *fleet = p + 9;
+    int cell, shot;
+    ship *s;
+
+    if (hashFleet(getInt(p + 1, 8), fleet, NET_FLEET_BYTES * g->rules.nships) != n->commit)
+        return NET_COMMIT;
+
+    for (int i = 0; i < g->rules.nships; i++, fleet += NET_FLEET_BYTES)
+    {
+        s = &remote->ships[i];
+        cell = getCell(g, fleet);
+        if (s->sunk ? (s->cells[s->center] != cell || s->rot != fleet[4]) : placeRevealed(remote, s, cell, fleet[4]))
+            return NET_COMMIT;
+    }
+
+    // every hit must be on a ship and every miss off one
+    for (cell = 0; cell < g->rules.width * g->rules.height; cell++)
+    {
+        shot = shotAt(local, cell);
+        if (shot && (shot == SHOT_HIT) != (shipAtCell(remote, cell) != NO_SHIP))
+            return NET_COMMIT;
+    }
+    n->state = NET_OVER;
+    remote->dirty = true;
+    return NET_OK;
+}
+
+// handle one complete message from peer
+// returns NET_OK, or reason to close session
+int handleMessage(netSession *n, game *g, const unsigned char *p)
+{
+    double sent;
+    int cell, result;
+
+    switch (p[0])
+    {
+    case 'H':
+        return (!n->host && n->state == NET_CONNECTING) ? readHello(n, g, p) : NET_PROTOCOL;
+
+    case 'F':
+        return (n->host && n->state == NET_PLACING && !n->peerReady) ? readFleet(n, g, p) : NET_PROTOCOL;
+
+    case 'R':
+        if (n->host || n->state != NET_PLACING || !n->localReady)
+            return NET_PROTOCOL;
+        n->commit = getInt(p + 1, 8);
+        n->state = NET_PLAYING;
+        g->started = true;
+        g->turn = n->first ? 0 : 1; // host shoots first unless it said otherwise
+        if (n->strategy != NULL)
+            n->strategy->init(&g->guesses[0]);
+        return NET_OK;
+
+    // host resolves client's shot
+    case 'S':
+        cell = getCell(g, p + 1);
+        if (!n->host || n->state != NET_PLAYING || g->turn % 2 != 1 || cell < 0)
+            return NET_PROTOCOL;
+        result = fireShot(g, cell % g->rules.width + 1, cell / g->rules.width + 1);
+        if (!result)
+            return NET_PROTOCOL;
+        sendResult(n, g, 1, result);
+        return NET_OK;
+
+    case 'X':
+        return (!n->host && n->state == NET_PLAYING) ? readResult(n, g, p) : NET_PROTOCOL;
+
+    case 'V':
+        return (!n->host && n->state == NET_PLAYING && !g->running) ? readReveal(n, g, p) : NET_PROTOCOL;
+
+    case 'P':
+        putInt(n, 'Q', 1);
+        putBytes(n, p + 1, 8);
+        return NET_OK;
+
+    case 'Q':
+        sent = getInt(p + 1, 8) / 1e6;
+        if (sent > netTime())
+            return NET_PROTOCOL;
+        countRoundTrip(n, sent);
+        return NET_OK;
+
+    // peer closes after reporting an error, so it isn't sent back
+    case 'E':
+        close(n->sock);
+        n->sock = -1;
+        return (p[1] > NET_OK && p[1] <= NET_SOCKET) ? p[1] : NET_PROTOCOL;
+    }
+    return NET_PROTOCOL;
+}
+/********************************************************************/
+
+/* Sessions
+*********************************************************************/
+void initializeSession(netSession *n, bool host, bool display)
+{
+    memset(n, 0, offsetof(netSession, in));
+    n->listener = -1;
+    n->sock = -1;
+    n->host = host;
+    n->display = display;
+    n->state = NET_CONNECTING;
+    n->error = NET_OK;
+    n->strategy = NULL;
+    n->lastPing = netTime() - NET_PING_INTERVAL; // ping as soon as connected
+#ifdef _WIN32
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+}
+
+// listen for a client on port of every interface, client is accepted by pollSession()
+// returns 0 on success, 1 if port can't be listened on
+int hostSession(netSession *n, int port, bool display)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+
+    initializeSession(n, true, display);
+    n->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (n->listener < 0)
+        return 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    setsockopt(n->listener, SOL_SOCKET, SO_REUSEADDR, (const char *)&one, sizeof(one));
+    if (bind(n->listener, (struct sockaddr *)&addr, sizeof(addr)) || listen(n->listener, 1) || setNonBlocking(n->listener))
+    {
+        closeSession(n, NET_SOCKET);
+        return 1;
+    }
+    return 0;
+}
+
+// connect to host at address and port, waiting until connected
+// returns 0 on success, 1 if host can't be reached
+int joinSession(netSession *n, const char *address, int port, bool display)
+{
+    struct addrinfo hints, *found, *a;
+    char service[16];
+
+    initializeSession(n, false, display);
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(address, service, &hints, &found))
+        return 1;
+
+    for (a = found; a != NULL && n->sock < 0; a = a->ai_next)
+    {
+        n->sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (n->sock >= 0 && connect(n->sock, a->ai_addr, a->ai_addrlen))
+        {
+            close(n->sock);
+            n->sock = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (n->sock < 0 || setNonBlocking(n->sock))
+    {
+        closeSession(n, NET_SOCKET);
+        return 1;
+    }
+    return 0;
+}
+
+// close connection, telling peer why if session failed on this side
+// error is NET_OK if session ended normally
+void closeSession(netSession *n, int error)
+{
+    unsigned char msg[2] = {'E', error};
+
+    if (n->sock >= 0 && error != NET_OK && error != NET_DISCONNECTED && error != NET_SOCKET)
+        send(n->sock, (const char *)msg, sizeof(msg), MSG_NOSIGNAL);
+    if (n->listener >= 0)
+        close(n->listener);
+    if (n->sock >= 0)
+        close(n->sock);
+    n->listener = -1;
+    n->sock = -1;
+    n->outLen = 0;
+    if (error != NET_OK)
+    {
+        n->state = NET_CLOSED;
+        n->error = error;
+    }
+}
+
+const char *sessionError(int error)
+{
+    switch (error)
+    {
+    case NET_OK:
+        return "no error";
+    case NET_DISCONNECTED:
+        return "opponent disconnected";
+    case NET_PROTOCOL:
+        return "opponent sent an invalid message";
+    case NET_RULES:
+        return "host's rules can't be played here";
+    case NET_DESYNC:
+        return "host's result doesn't match this game";
+    case NET_COMMIT:
+        return "host's fleet doesn't match its commitment";
+    case NET_SOCKET:
+        return "network error";
+    }
+    return "unknown error";
+}
+
+// socket to wait on for session's next event, listening socket until a client connects
+int sessionSocket(netSession *n)
+{
+    return (n->sock >= 0) ? n->sock : n->listener;
+}
+
+// count round trip of a message sent at given netTime()
+void countRoundTrip(netSession *n, double sent)
+{
+    n->rtt = netTime() - sent;
+    n->rttTotal += n->rtt;
+    if (n->trips == 0 || n->rtt < n->rttMin)
+        n->rttMin = n->rtt;
+    if (n->rtt > n->rttMax)
+        n->rttMax = n->rtt;
+    n->trips++;
+}
+
+// monotonic clock in seconds
+double netTime(void)
+{
+#ifdef _WIN32
+    return GetTickCount64() / 1e3;
+#else
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+#endif
+}
+/********************************************************************/
+
+/* Network Game
+*********************************************************************/
+// accept client, read and apply peer's messages, send pings and queued messages w/o blocking
+// call every frame
+// returns 0 if session is open or ended normally, 1 if it closed w/ an error, see error
+int pollSession(netSession *n, game *g)
+{
+    long len, received;
+    size_t done = 0;
+    int sock, error;
+    bool closed = false;
+
+    if (n->state == NET_CLOSED)
+        return 1;
+
+    // host accepts client and tells it the rules
+    if (n->sock < 0 && n->listener >= 0)
+    {
+        sock = accept(n->listener, NULL, NULL);
+        if (sock < 0)
+        {
+            if (!wouldBlock())
+                closeSession(n, NET_SOCKET);
+            return n->state == NET_CLOSED;
+        }
+        close(n->listener);
+        n->listener = -1;
+        n->sock = sock;
+        if (setNonBlocking(sock))
+        {
+            closeSession(n, NET_SOCKET);
+            return 1;
+        }
+
+        putInt(n, 'H', 1);
+        putBytes(n, NET_MAGIC, 4);
+        putInt(n, NET_VERSION, 1);
+        putInt(n, g->rules.width, 2);
+        putInt(n, g->rules.height, 2);
+        putInt(n, g->rules.nships, 2);
+        for (int i = 0; i < g->rules.nships; i++)
+            putInt(n, g->rules.lens[i], 1);
+        putInt(n, 0, 1); // host shoots first
+        n->state = NET_PLACING;
+    }
+    if (n->sock < 0)
+        return 0;
+
+    if (netTime() - n->lastPing >= NET_PING_INTERVAL)
+    {
+        n->lastPing = netTime();
+        putInt(n, 'P', 1);
+        putInt(n, n->lastPing * 1e6, 8);
+    }
+
+    // read everything that arrived
+    while (n->sock >= 0 && n->inLen < NET_BUFFER_SIZE)
+    {
+        received = recv(n->sock, (char *)n->in + n->inLen, NET_BUFFER_SIZE - n->inLen, 0);
+        if (received == 0 || (received < 0 && !wouldBlock()))
+            closed = true;
+        if (received <= 0)
+            break;
+        n->inLen += received;
+    }
+
+    // apply every complete message in order
+    while (n->sock >= 0 && done < n->inLen)
+    {
+        len = messageLength(g, n->in + done, n->inLen - done);
+        if (len < 0 || len > NET_BUFFER_SIZE)
+        {
+            closeSession(n, NET_PROTOCOL);
+            return 1;
+        }
+        if (len == 0 || done + len > n->inLen)
+            break;
+        error = handleMessage(n, g, n->in + done);
+        if (error != NET_OK)
+        {
+            closeSession(n, error);
+            return 1;
+        }
+        done += len;
+    }
+    memmove(n->in, n->in + done, n->inLen - done);
+    n->inLen -= done;
+
+    // peer closes once game is over, messages it sent before closing are applied first
+    if (closed)
+        closeSession(n, (n->state == NET_OVER) ? NET_OK : NET_DISCONNECTED);
+    flushSession(n);
+    return n->state == NET_CLOSED;
+}
+
+// local player's fleet is placed, client sends it to host and host commits to its own
+// returns 0 on success, 1 if fleets aren't being placed or a ship isn't placed yet
+int commitFleet(netSession *n, game *g)
+{
+    unsigned char fleet[NET_FLEET_BYTES * MAX_SHIPS];
+    player *p = &g->players[0];
+
+    if (n->state != NET_PLACING || n->localReady)
+        return 1;
+    for (int i = 0; i < p->nships; i++)
+    {
+        if (!p->ships[i].isPlaced)
+            return 1;
+    }
+
+    fleetBytes(p, fleet);
+    n->localReady = true;
+    if (n->host)
+    {
+        // opponent's computer state isn't used in network games, so its generator can salt commitment
+        n->salt = rngNext(&g->guesses[1].rng) ^ (uint64_t)(netTime() * 1e9);
+        n->commit = hashFleet(n->salt, fleet, NET_FLEET_BYTES * p->nships);
+        tryStart(n, g);
+    }
+    else
+    {
+        putInt(n, 'F', 1);
+        putBytes(n, fleet, NET_FLEET_BYTES * p->nships);
+    }
+    flushSession(n);
+    return 0;
+}
+
+// it's local player's turn to shoot
+bool localTurn(netSession *n, game *g)
+{
+    return n->state == NET_PLAYING && g->running && g->turn % 2 == 0 && !n->waiting;
+}
+
+// local player shoots at x, y on opponent's board
+// host resolves shot at once, client sends it to host and applies result once it arrives
+// returns 0 if shot was taken or sent, 1 if it's not local player's turn or shot isn't allowed
+int sendShot(netSession *n, game *g, int x, int y)
+{
+    int result;
+
+    if (!localTurn(n, g))
+        return 1;
+
+    if (n->host)
+    {
+        result = fireShot(g, x, y);
+        if (!result)
+            return 1;
+        sendResult(n, g, 0, result);
+    }
+    else
+    {
+        if (x > g->rules.width || x < 1 || y > g->rules.height || y < 1 || shotAt(&g->players[0], cellIndex(&g->players[1], x, y)))
+            return 1;
+        putInt(n, 'S', 1);
+        putInt(n, cellIndex(&g->players[1], x, y), 4);
+        n->waiting = true;
+        n->shotSent = netTime();
+        n->pendingX = x;
+        n->pendingY = y;
+    }
+    flushSession(n);
+    return 0;
+}
+
+// local computer player shoots using session's strategy
+// returns same as sendShot()
+int sendComputerShot(netSession *n, game *g)
+{
+    int x, y, result;
+
+    if (n->strategy == NULL || !localTurn(n, g))
+        return 1;
+
+    if (n->host)
+    {
+        result = strategyShot(n->strategy, &g->players[1], &g->players[0], &g->running, &g->guesses[0]);
+        if (!result)
+            return 1;
+        g->turn++;
+        sendResult(n, g, 0, result);
+        flushSession(n);
+        return 0;
+    }
+
+    n->strategy->chooseShot(&g->players[1], &g->players[0], &g->guesses[0], &x, &y);
+    return sendShot(n, g, x, y);
+}
+/********************************************************************/
@@ -0,0 +1,124 @@
+#ifndef __NETWORK_H__
+#define __NETWORK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game.h"
+
+/*
+Two-player network protocol over TCP
+
+The host plays player 0, shoots first, and resolves every shot w/ its engine,
+so its results are authoritative. The client sends its fleet to the host once
+placed and only learns where the host's ships are as they sink. The host commits
+to its fleet w/ a hash when the game begins and reveals it once the game is over,
+so the client can check every result it was given against it.
+
+Messages are a type byte followed by fixed fields, integers little endian:
+
+HELLO   'H' "BSNP", version u8, width u16, height u16, nships u16, len u8 of each ship,  host -> client
+            then first u8, 1 if client shoots first
+FLEET   'F' center cell u32 and rotation u8 of each ship                                  client -> host
+READY   'R' commit u64, hash of salt and host's fleet                                      host -> client
+SHOT    'S' cell u32                                                                       client -> host
+RESULT  'X' shooter u8, cell u32, result u8, see fireAt(),                                 host -> client
+            then ship u16, center cell u32 and rotation u8 of ship if result sank it
+REVEAL  'V' salt u64, center cell u32 and rotation u8 of each of host's ships              host -> client
+PING    'P' sender's clock in microseconds u64                                             either way
+PONG    'Q' clock of PING answered u64                                                     either way
+ERROR   'E' reason u8, see sessionError()                                                  either way, then close
+
+Shooter is 0 for the host and 1 for the client. Cells are indexes of cellIndex().
+A host playing a client shoots first. A server matching two clients, see server.c,
+acts as host to each of them and tells one of them to shoot first.
+*/
+
+#define NET_MAGIC "BSNP"
+#define NET_VERSION 2
+#define NET_PORT 7510            // port host listens on by default
+#define NET_BUFFER_SIZE 8192     // bytes buffered each way, fits a fleet of MAX_SHIPS ships
+#define NET_PING_INTERVAL 1.0    // seconds between pings measuring round trip time
+#define NET_POLL_TIME 0.001      // longest a frame loop should wait before polling session again
+#define NET_FLEET_BYTES 5        // bytes of each ship's placement in FLEET and REVEAL messages
+
+// session states
+#define NET_CONNECTING 0 // host waiting for client to connect
+#define NET_PLACING 1    // connected, fleets being placed
+#define NET_PLAYING 2    // both fleets placed, shots being taken
+#define NET_OVER 3       // game over and host's fleet revealed
+#define NET_CLOSED 4     // connection closed because of an error
+
+// reasons a session closed, see sessionError()
+#define NET_OK 0
+#define NET_DISCONNECTED 1 // peer closed connection before game was over
+#define NET_PROTOCOL 2     // peer sent a message that isn't valid here
+#define NET_RULES 3        // host's rules can't be played by client
+#define NET_DESYNC 4       // host's result of a shot doesn't match client's engine
+#define NET_COMMIT 5       // host's revealed fleet doesn't match its commitment or results
+#define NET_SOCKET 6       // socket failed
+
+// connection to other player of a network game
+typedef struct
+{
+    int listener;   // host's listening socket until client connects, -1 otherwise
+    int sock;       // connection to peer, -1 until connected
+    bool host;
+    bool display;   // local game is drawn by the SDL game, so only rules that fit its grid can be played
+    int state;
+    int error;      // reason session closed, NET_OK if it wasn't
+    bool localReady; // local fleet is placed and sent or committed to
+    bool peerReady;  // host received client's fleet
+    bool waiting;    // client sent a shot and waits for its result
+    bool first;      // client shoots first, as host's HELLO said
+    int pendingX, pendingY;
+    uint64_t salt, commit;
+    const strategy *strategy; // strategy of local computer player, observes results of its shots, NULL if none
+
+    // round trip times in seconds of pings, and of client's shots until their results arrive
+    double lastPing, shotSent;
+    long trips;
+    double rtt, rttTotal, rttMin, rttMax;
+
+    unsigned char in[NET_BUFFER_SIZE], out[NET_BUFFER_SIZE];
+    size_t inLen, outLen;
+} netSession;
+
+/* Sessions
+*********************************************************************/
+void initializeSession(netSession *n, bool host, bool display);
+int hostSession(netSession *n, int port, bool display);
+int joinSession(netSession *n, const char *address, int port, bool display);
+void closeSession(netSession *n, int error);
+const char *sessionError(int error);
+int sessionSocket(netSession *n);
+void countRoundTrip(netSession *n, double sent);
+double netTime(void);
+/********************************************************************/
+
+/* Messages
+    helpers hosts other than pollSession(), like battleship-server, build messages w/
+*********************************************************************/
+int setNonBlocking(int sock);
+bool wouldBlock(void);
+void flushSession(netSession *n);
+void putBytes(netSession *n, const void *bytes, size_t len);
+void putInt(netSession *n, uint64_t value, int bytes);
+uint64_t getInt(const unsigned char *p, int bytes);
+int getCell(game *g, const unsigned char *p);
+uint64_t hashFleet(uint64_t salt, const unsigned char *fleet, size_t len);
+void fleetBytes(player *p, unsigned char *fleet);
+long messageLength(game *g, const unsigned char *p, size_t avail);
+/********************************************************************/
+
+/* Network Game
+    local player is players[0] of game on both sides
+*********************************************************************/
+int pollSession(netSession *n, game *g);
+int commitFleet(netSession *n, game *g);
+bool localTurn(netSession *n, game *g);
+int sendShot(netSession *n, game *g, int x, int y);
+int sendComputerShot(netSession *n, game *g);
+/********************************************************************/
+
+#endif
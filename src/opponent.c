@@ -0,0 +1,281 @@
+#include <stddef.h>
+#include "opponent.h"
+
+/* Computer Player
+**********************************************************************
+*********************************************************************/
+
+// set opponentGuess struct to default values
+void resetOpGuess(opponentGuess *opGuess)
+{
+    opGuess->initX = 0;
+    opGuess->initY = 0;
+    opGuess->offset1 = 0;
+    opGuess->offset2 = 0;
+    opGuess->rot = -1;
+}
+
+// allow every placement of every ship length again
+void resetPlacements(opponentGuess *opGuess)
+{
+    for (int len = 0; len <= MAX_SHIP_LEN; len++)
+    {
+        for (int i = 0; i < PLACEMENT_WORDS; i++)
+            opGuess->placements[len][i] = ~(uint64_t)0;
+    }
+}
+
+// place opponent's ships at random locations w/ random rotations
+// every placement that fits around ships already placed is equally likely, so each fleet costs the same
+// returns 0 if placed, 1 if ships kept failing to fit around ships placed before them
+int initializeOpponent(player *p, opponentGuess *opGuess)
+{
+    ship *s;
+    bitboard mask;
+    int x, y, rot, i, result;
+
+    for (int tries = 0; tries < MAX_FLEET_TRIES; tries++)
+    {
+        for (i = 0; i < p->nships; i++)
+        {
+            s = &p->ships[i];
+
+            // 10 x 10 boards place from bitboard layers, standard fleet always fits around ships placed before it
+            if (p->bitboards)
+                result = randomPlacement(&opGuess->rng, bbAndNot(bbFull(), bbAndNot(p->fleet, s->mask)), s->len, &x, &y, &rot, &mask);
+            else if (p->sparse)
+                result = randomSparsePlacement(&opGuess->rng, p, s, &x, &y, &rot);
+            else
+                result = randomShipPlacement(&opGuess->rng, p, s, &x, &y, &rot);
+            if (result)
+                break;
+
+            removeShip(p, s);
+            s->rot = rot;
+            s->isPlaced = true;
+            if (addShip(p, s, x, y))
+                return 1; // out of memory, trying again won't help
+            updateShipPos(p, s); // mark board to be redrawn
+        }
+        if (i == p->nships)
+            return 0;
+
+        // start fleet over if a ship didn't fit
+        for (i = 0; i < p->nships; i++)
+        {
+            s = &p->ships[i];
+            removeShip(p, s);
+            s->rot = 0;
+            s->isPlaced = false;
+            updateShipPos(p, s);
+        }
+    }
+    return 1;
+}
+
+// pick a random placement of ship on a board kept in per-cell arrays that doesn't overlap other ships
+// sets center and rotation of ship like randomPlacement(), w/ placements in the same order
+// returns 1 if no placement fits
+int randomShipPlacement(rng *r, player *p, ship *s, int *x, int *y, int *rot)
+{
+    unsigned char right[MAX_CELLS], down[MAX_CELLS]; // free cells from each cell rightwards and downwards
+    int nHorizontal = 0, count = 0, draw, placement, cell, flip, id, len = s->len;
+    bool horizontal;
+
+    // free runs of each cell from the one after it, ship's own cells count as free
+    for (int cellY = p->height; cellY >= 1; cellY--)
+    {
+        for (int cellX = p->width; cellX >= 1; cellX--)
+        {
+            cell = cellIndex(p, cellX, cellY);
+            id = p->shipAt[cell];
+            if (id != NO_SHIP && id != s - p->ships)
+            {
+                right[cell] = 0;
+                down[cell] = 0;
+                continue;
+            }
+            right[cell] = ((cellX < p->width) ? right[cell + 1] : 0) + 1;
+            down[cell] = ((cellY < p->height) ? down[cell + p->width] : 0) + 1;
+            nHorizontal += right[cell] >= len;
+            count += down[cell] >= len;
+        }
+    }
+    count += nHorizontal;
+    if (count == 0)
+        return 1;
+
+    // one draw picks placement and which end of ship it points from
+    draw = rngBounded(r, 2 * count);
+    placement = draw >> 1;
+    flip = draw & 1;
+
+    // find leftmost or topmost cell of placement, horizontal ones before vertical ones
+    horizontal = placement < nHorizontal;
+    if (!horizontal)
+        placement -= nHorizontal;
+    for (cell = 0;; cell++)
+    {
+        if ((horizontal ? right[cell] : down[cell]) >= len && placement-- == 0)
+            break;
+    }
+
+    *x = cell % p->width + 1;
+    *y = cell / p->width + 1;
+    if (horizontal)
+    {
+        *x += flip ? len - 1 - s->center : s->center;
+        *rot = flip ? 2 : 0;
+    }
+    else
+    {
+        *y += flip ? len - 1 - s->center : s->center;
+        *rot = flip ? 3 : 1;
+    }
+    return 0;
+}
+
+// pick a random placement of ship on a sparse board that doesn't overlap other ships
+// random placements are tried until one fits, which is quick while the ocean is mostly empty
+// sets center and rotation of ship like randomPlacement(), returns 1 if no placement tried fits
+int randomSparsePlacement(rng *r, player *p, ship *s, int *x, int *y, int *rot)
+{
+    for (int i = 0; i < MAX_PLACEMENT_TRIES; i++)
+    {
+        *rot = rngBounded(r, 4);
+        *x = rngBounded(r, p->width) + 1;
+        *y = rngBounded(r, p->height) + 1;
+        if (shipFits(p, s, *x, *y, *rot))
+            return 0;
+    }
+    return 1;
+}
+
+// leftmost cells of horizontal placements and topmost cells of vertical placements
+// of a ship of given length that only cover free cells
+void placementAnchors(bitboard freeCells, int len, bitboard *horizontal, bitboard *vertical)
+{
+    bitboard h = freeCells, v = freeCells, fit = bbEmpty(), row;
+
+    // cell stays set if the next len - 1 cells right of/below it are free too
+    for (int i = 1; i < len; i++)
+    {
+        h = bbAnd(h, bbShiftDown(freeCells, i));
+        v = bbAnd(v, bbShiftDown(freeCells, i * BOARD_SIZE));
+    }
+
+    // horizontal placements can't wrap onto next row, vertical ones already stop at bottom of board
+    row.w[0] = ((uint64_t)1 << (BOARD_SIZE - len + 1)) - 1;
+    row.w[1] = 0;
+    for (int y = 1; y <= BOARD_SIZE; y++)
+        fit = bbOr(fit, bbShift(row, bbIndex(1, y)));
+
+    *horizontal = bbAnd(h, fit);
+    *vertical = v;
+}
+
+// pick a random placement of a ship of given length that only covers free cells
+// sets center, rotation and mask of ship, every placement and both rotations of it are equally likely
+// returns 1 if no placement fits
+int randomPlacement(rng *r, bitboard freeCells, int len, int *x, int *y, int *rot, bitboard *mask)
+{
+    bitboard horizontal, vertical, line = bbEmpty();
+    int nHorizontal, count, draw, placement, cell, flip, center = len / 2;
+
+    placementAnchors(freeCells, len, &horizontal, &vertical);
+    nHorizontal = bbCount(horizontal);
+    count = nHorizontal + bbCount(vertical);
+    if (count == 0)
+        return 1;
+
+    // one draw picks placement and which end of ship it points from
+    draw = rngBounded(r, 2 * count);
+    placement = draw >> 1;
+    flip = draw & 1;
+
+    if (placement < nHorizontal)
+    {
+        cell = bbNth(horizontal, placement);
+        line.w[0] = ((uint64_t)1 << len) - 1;
+        *x = cell % BOARD_SIZE + 1 + (flip ? len - 1 - center : center);
+        *y = cell / BOARD_SIZE + 1;
+        *rot = flip ? 2 : 0;
+    }
+    else
+    {
+        cell = bbNth(vertical, placement - nHorizontal);
+        for (int i = 0; i < len; i++)
+            bbSet(&line, i * BOARD_SIZE);
+        *x = cell % BOARD_SIZE + 1;
+        *y = cell / BOARD_SIZE + 1 + (flip ? len - 1 - center : center);
+        *rot = flip ? 3 : 1;
+    }
+    *mask = bbShift(line, cell);
+    return 0;
+}
+
+// generate count random fleets of nships ships w/ given lengths on a 10 x 10 board for Monte Carlo use
+// masks[i * nships + j] is cells of ship j in fleet i, ships are placed in order like initializeOpponent()
+// returns number of fleets generated, fewer than count only if ships keep failing to fit
+long randomFleets(rng *r, const int *lens, int nships, bitboard *masks, long count)
+{
+    bitboard freeCells, *fleet;
+    int x, y, rot, tries = 0, j;
+
+    for (long i = 0; i < count; i++)
+    {
+        fleet = &masks[i * nships];
+        freeCells = bbFull();
+        for (j = 0; j < nships; j++)
+        {
+            if (randomPlacement(r, freeCells, lens[j], &x, &y, &rot, &fleet[j]))
+                break;
+            freeCells = bbAndNot(freeCells, fleet[j]);
+        }
+
+        // start fleet over if a ship didn't fit
+        if (j < nships)
+        {
+            if (++tries >= MAX_FLEET_TRIES)
+                return i;
+            i--;
+            continue;
+        }
+        tries = 0;
+    }
+    return count;
+}
+
+// number of placements of a ship of given length on 10 x 10 board
+int placementCount(int len)
+{
+    return 2 * (BOARD_SIZE - len + 1) * BOARD_SIZE;
+}
+
+// mask of cells covered by a placement of a ship of given length
+bitboard placementMask(int len, int placement)
+{
+    bitboard line = bbEmpty();
+    int positions = BOARD_SIZE - len + 1, horizontal = positions * BOARD_SIZE, x, y;
+
+    if (placement < horizontal)
+    {
+        // consecutive cells in a row
+        x = placement % positions + 1;
+        y = placement / positions + 1;
+        line.w[0] = ((uint64_t)1 << len) - 1;
+    }
+    else
+    {
+        // cells BOARD_SIZE apart in a column
+        placement -= horizontal;
+        x = placement % BOARD_SIZE + 1;
+        y = placement / BOARD_SIZE + 1;
+        for (int i = 0; i < len; i++)
+            bbSet(&line, i * BOARD_SIZE);
+    }
+    return bbShift(line, bbIndex(x, y));
+}
+
+/*********************************************************************
+*********************************************************************/
\ No newline at end of file
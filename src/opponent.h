@@ -0,0 +1,47 @@
+#ifndef __OPPONENT_H__
+#define __OPPONENT_H__
+
+#include <stdint.h>
+#include "engine.h"
+#include "rng.h"
+
+// placements of a ship of one length on 10 x 10 board: horizontal then vertical, by leftmost/topmost cell
+#define MAX_PLACEMENTS (2 * BOARD_SIZE * BOARD_SIZE)
+#define PLACEMENT_WORDS ((MAX_PLACEMENTS + 63) / 64)
+
+#define MAX_FLEET_TRIES 100      // attempts at a fleet randomFleets() and initializeOpponent() make before giving up
+#define MAX_PLACEMENT_TRIES 1000 // placements of a ship tried on a sparse board before giving up
+#define MAX_OPEN_HITS 64         // hits on ships not sunk yet density tracks on a sparse board, later ones are left for hunting
+
+// stores data about computer player's guess
+typedef struct
+{
+    int initX, initY;
+    int offset1, offset2;
+    int rot;
+    uint64_t placements[MAX_SHIP_LEN + 1][PLACEMENT_WORDS]; // placements of each ship length not ruled out yet
+    rng rng;                                                // source of computer player's random choices
+
+    // cells of shooter's hits on ships not sunk yet, oldest first
+    // learned from results of shooter's own shots, since sparse boards have no hit layer to find them in
+    int openHits[MAX_OPEN_HITS];
+    int nopenHits;
+} opponentGuess;
+
+/* Computer Player
+**********************************************************************
+*********************************************************************/
+void resetOpGuess(opponentGuess *opGuess);
+void resetPlacements(opponentGuess *opGuess);
+int initializeOpponent(player *p, opponentGuess *opGuess);
+int randomShipPlacement(rng *r, player *p, ship *s, int *x, int *y, int *rot);
+int randomSparsePlacement(rng *r, player *p, ship *s, int *x, int *y, int *rot);
+void placementAnchors(bitboard freeCells, int len, bitboard *horizontal, bitboard *vertical);
+int randomPlacement(rng *r, bitboard freeCells, int len, int *x, int *y, int *rot, bitboard *mask);
+long randomFleets(rng *r, const int *lens, int nships, bitboard *masks, long count);
+int placementCount(int len);
+bitboard placementMask(int len, int placement);
+/*********************************************************************
+*********************************************************************/
+
+#endif
\ No newline at end of file
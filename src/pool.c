@@ -0,0 +1,92 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include "pool.h"
+
+/* Pools
+*********************************************************************/
+// allocate capacity slots of at least size bytes each
+// slots aren't cleared, so pages of a slot are only touched once it's used
+// returns 0 on success, 1 if memory ran out
+int initializePool(pool *p, size_t size, long capacity)
+{
+    void *slots;
+
+    p->size = (size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+    p->capacity = capacity;
+    p->slots = NULL;
+    p->nunused = 0;
+    p->touched = 0;
+    p->unused = malloc(capacity * sizeof(long));
+#ifdef _WIN32
+    slots = _aligned_malloc(p->size * capacity, CACHE_LINE);
+    if (p->unused == NULL || slots == NULL)
+#else
+    if (p->unused == NULL || posix_memalign(&slots, CACHE_LINE, p->size * capacity))
+#endif
+    {
+        freePool(p);
+        return 1;
+    }
+    p->slots = slots;
+
+    // lowest slots are acquired first, so a lightly used pool stays compact
+    for (long i = capacity - 1; i >= 0; i--)
+        p->unused[p->nunused++] = i;
+    return 0;
+}
+
+void freePool(pool *p)
+{
+#ifdef _WIN32
+    _aligned_free(p->slots);
+#else
+    free(p->slots);
+#endif
+    free(p->unused);
+    p->slots = NULL;
+    p->unused = NULL;
+    p->capacity = 0;
+    p->nunused = 0;
+    p->touched = 0;
+}
+
+// take an unused slot, left as its last user released it, or uninitialized if it was never used
+// slot was never used if its index is p->touched before acquiring it
+// returns NULL if every slot is in use
+void *acquireSlot(pool *p)
+{
+    long index;
+
+    if (p->nunused == 0)
+        return NULL;
+    index = p->unused[--p->nunused];
+    if (index >= p->touched)
+        p->touched = index + 1;
+    return poolSlot(p, index);
+}
+
+// return slot from acquireSlot() to pool
+void releaseSlot(pool *p, void *slot)
+{
+    p->unused[p->nunused++] = slotIndex(p, slot);
+}
+
+void *poolSlot(const pool *p, long index)
+{
+    return p->slots + index * p->size;
+}
+
+long slotIndex(const pool *p, const void *slot)
+{
+    return ((const unsigned char *)slot - p->slots) / p->size;
+}
+
+long slotsInUse(const pool *p)
+{
+    return p->capacity - p->nunused;
+}
+/********************************************************************/
@@ -0,0 +1,31 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+#define CACHE_LINE 64 // bytes slots are aligned to, so neighbouring slots never share a cache line
+
+// fixed capacity arena of equally sized slots, allocated once
+// slots are acquired and released in O(1) w/o touching the allocator
+typedef struct
+{
+    unsigned char *slots; // capacity slots, first one cache line aligned
+    size_t size;          // bytes of each slot, rounded up to a multiple of CACHE_LINE
+    long capacity;
+    long *unused;         // stack of indexes of unused slots
+    long nunused;
+    long touched;         // slots acquired at least once, always the lowest indexes, later slots were never touched
+} pool;
+
+/* Pools
+*********************************************************************/
+int initializePool(pool *p, size_t size, long capacity);
+void freePool(pool *p);
+void *acquireSlot(pool *p);
+void releaseSlot(pool *p, void *slot);
+void *poolSlot(const pool *p, long index);
+long slotIndex(const pool *p, const void *slot);
+long slotsInUse(const pool *p);
+/********************************************************************/
+
+#endif
@@ -1,5 +1,214 @@
+#include <stdio.h>
 #include "rendering.h"
 
+// initialize SDL events, inputs, window, and renderer
+SDL_Renderer *initializeSDL(SDL_Window *window, const char *title, int width, int height)
+{
+    // Initializes the timer, audio, video, joystick,
+    // haptic, gamecontroller and events subsystems
+    if (SDL_Init(SDL_INIT_EVERYTHING) != 0)
+    {
+        printf("Error initializing SDL: %s\n", SDL_GetError());
+        return 0;
+    }
+
+    //Initialize SDL_ttf
+    if (TTF_Init() != 0)
+    {
+        printf("Error initializing SDL_ttf: %s\n", TTF_GetError());
+        return 0;
+    }
+
+    // Create a window
+    window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, 0);
+    if (!window)
+    {
+        printf("Error creating window: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 0;
+    }
+
+    // Create a renderer
+    // no vsync, game loop paces itself and only presents frames that changed
+    Uint32 render_flags = SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE;
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, render_flags);
+    if (!renderer)
+    {
+        printf("Error creating renderer: %s\n", SDL_GetError());
+        SDL_DestroyWindow(window);
+        SDL_Quit();
+        return 0;
+    }
+
+    return renderer;
+}
+
+// Release SDL resources
+void teardown(SDL_Renderer *renderer, SDL_Window *window, renderCache *cache)
+{
+    destroyRenderCache(cache);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+    TTF_Quit();
+    SDL_Quit();
+}
+
+// seconds from monotonic high resolution counter, only differences between calls are meaningful
+double getTime(void)
+{
+    return (double)SDL_GetPerformanceCounter() / SDL_GetPerformanceFrequency();
+}
+
+// empty input queue
+void initializeInput(inputQueue *q)
+{
+    q->head = 0;
+    q->tail = 0;
+}
+
+// add event to input queue
+// mouse motion replaces motion queued right before it, only latest position matters
+// returns false if queue is full
+bool queueInput(inputQueue *q, SDL_Event *event)
+{
+    if (event->type == SDL_MOUSEMOTION && q->tail != q->head && q->events[(q->tail - 1) % INPUT_QUEUE_SIZE].type == SDL_MOUSEMOTION)
+    {
+        q->events[(q->tail - 1) % INPUT_QUEUE_SIZE] = *event;
+        return true;
+    }
+    if (q->tail - q->head == INPUT_QUEUE_SIZE)
+        return false;
+    q->events[q->tail++ % INPUT_QUEUE_SIZE] = *event;
+    return true;
+}
+
+// get input from user
+// e.g. keyboard and mouse
+// sleeps until an event arrives or timeout seconds pass, timeout < 0 waits for next event
+// then moves every pending event into queue, anything that doesn't fit stays in SDL's queue for next call
+// returns true if queue has events to handle
+bool waitInput(inputQueue *q, double timeout)
+{
+    int ms = (timeout < 0) ? -1 : (int)(timeout * 1000 + 0.5);
+    SDL_Event event;
+
+    // don't sleep if events are still waiting to be handled
+    if (q->tail != q->head)
+        ms = 0;
+
+    if (q->tail - q->head < INPUT_QUEUE_SIZE && SDL_WaitEventTimeout(&event, ms))
+    {
+        queueInput(q, &event);
+        while (q->tail - q->head < INPUT_QUEUE_SIZE && SDL_PollEvent(&event))
+            queueInput(q, &event);
+    }
+    return q->tail != q->head;
+}
+
+// take oldest event from queue
+// returns false if queue is empty
+bool nextInput(inputQueue *q, SDL_Event *event)
+{
+    if (q->tail == q->head)
+        return false;
+    *event = q->events[q->head++ % INPUT_QUEUE_SIZE];
+    return true;
+}
+
+/* Render Resources
+**********************************************************************
+*********************************************************************/
+
+// open font and render ship numbers and all messages into one atlas texture
+// draw parts of window that never change into a texture the size of window
+// returns 0 if created, 1 on error
+int createRenderCache(SDL_Renderer *renderer, renderCache *cache, int width, int height)
+{
+    SDL_Color color = {255, 255, 255, 255}; // color text white
+    SDL_Surface *surfaces[NSHIPS + NMESSAGES], *atlas;
+    const char *numbers[NSHIPS] = {"1", "2", "3", "4", "5"}; // ship selection numbers
+    SDL_Rect *rects[NSHIPS + NMESSAGES];
+    int atlasWidth = 0, atlasHeight = 0, result = 0;
+
+    cache->atlas = NULL;
+    cache->staticLayer = NULL;
+    cache->shown = NULL;
+    cache->font = TTF_OpenFont(FONT_FILE, FONT_SIZE);
+    if (!cache->font)
+    {
+        printf("Error opening font: %s\n", TTF_GetError());
+        return 1;
+    }
+
+    // render each string once, ship numbers first
+    for (int i = 0; i < NSHIPS + NMESSAGES; i++)
+    {
+        rects[i] = (i < NSHIPS) ? &cache->numbers[i] : &cache->messages[i - NSHIPS];
+        surfaces[i] = TTF_RenderText_Solid(cache->font, (i < NSHIPS) ? numbers[i] : message(i - NSHIPS), color);
+        if (!surfaces[i])
+        {
+            printf("Error rendering text: %s\n", TTF_GetError());
+            result = 1;
+            *rects[i] = (SDL_Rect){0, 0, 0, 0};
+            continue;
+        }
+
+        // stack strings in atlas
+        *rects[i] = (SDL_Rect){0, atlasHeight, surfaces[i]->w, surfaces[i]->h};
+        atlasHeight += surfaces[i]->h;
+        if (surfaces[i]->w > atlasWidth)
+            atlasWidth = surfaces[i]->w;
+    }
+
+    // copy strings into atlas surface, transparent outside text
+    atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA8888);
+    for (int i = 0; i < NSHIPS + NMESSAGES; i++)
+    {
+        if (atlas && surfaces[i])
+            SDL_BlitSurface(surfaces[i], NULL, atlas, rects[i]);
+        SDL_FreeSurface(surfaces[i]);
+    }
+    if (atlas)
+    {
+        cache->atlas = SDL_CreateTextureFromSurface(renderer, atlas);
+        SDL_FreeSurface(atlas);
+    }
+    if (!cache->atlas)
+    {
+        printf("Error creating text atlas: %s\n", SDL_GetError());
+        result = 1;
+    }
+
+    // static layer is only an optimization, draw it every frame if it can't be created
+    if (SDL_RenderTargetSupported(renderer))
+        cache->staticLayer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (cache->staticLayer)
+    {
+        SDL_SetRenderTarget(renderer, cache->staticLayer);
+        drawStaticLayer(renderer);
+        SDL_SetRenderTarget(renderer, NULL);
+    }
+
+    return result;
+}
+
+// free textures and close font
+void destroyRenderCache(renderCache *cache)
+{
+    if (cache->atlas)
+        SDL_DestroyTexture(cache->atlas);
+    if (cache->staticLayer)
+        SDL_DestroyTexture(cache->staticLayer);
+    if (cache->font)
+        TTF_CloseFont(cache->font);
+    cache->atlas = NULL;
+    cache->staticLayer = NULL;
+    cache->font = NULL;
+}
+
+/*********************************************************************
+*********************************************************************/
+
 /* Render Game
 **********************************************************************
 *********************************************************************/
@@ -13,133 +222,209 @@ void drawBackground(SDL_Renderer *renderer, int r, int g, int b, int a)
     SDL_RenderClear(renderer);
 }
 
+// add points of one connected strip of lines across a grid w/ top left corner at cell x, y
+// lines are drawn back and forth so the joins between them run along the grid's own border
+// returns number of points added
+int gridStrip(SDL_Point *points, int x, int y, int cells)
+{
+    int left = x * CELL_SIZE + 1, top = y * CELL_SIZE + 1, right = (x + cells) * CELL_SIZE + 1, bottom = (y + cells) * CELL_SIZE + 1, n = 0;
+
+    // horizontal lines, top to bottom
+    for (int i = 0; i <= cells; i++)
+    {
+        points[n++] = (SDL_Point){(i % 2) ? right : left, top + i * CELL_SIZE};
+        points[n++] = (SDL_Point){(i % 2) ? left : right, top + i * CELL_SIZE};
+    }
+
+    // vertical lines, starting from the corner the last horizontal line ended on
+    for (int i = 0; i <= cells; i++)
+    {
+        int lineX = (cells % 2) ? left + i * CELL_SIZE : right - i * CELL_SIZE;
+
+        points[n++] = (SDL_Point){lineX, ((cells + i) % 2) ? top : bottom};
+        points[n++] = (SDL_Point){lineX, ((cells + i) % 2) ? bottom : top};
+    }
+    return n;
+}
+
 // draw lines
+// each connected set of lines is one SDL_RenderDrawLines call
 void drawGrids(SDL_Renderer *renderer, int r, int g, int b, int a)
 {
+    SDL_Point grid[4 * (BOARD_SIZE + 1)];
+    int n;
+
+    // vertical dividing line, then message box along bottom
+    SDL_Point divider[] = {
+        {12 * CELL_SIZE + 1, 0},
+        {12 * CELL_SIZE + 1, CELL_SIZE * BOARD_SIZE_Y + 1},
+        {0, CELL_SIZE * BOARD_SIZE_Y + 1},
+        {CELL_SIZE * BOARD_SIZE_X + 1, CELL_SIZE * BOARD_SIZE_Y + 1}};
+
+    // selection box
+    SDL_Point selection[] = {
+        {13 * CELL_SIZE + 1, CELL_SIZE + 1},
+        {18 * CELL_SIZE + 1, CELL_SIZE + 1},
+        {18 * CELL_SIZE + 1, 6 * CELL_SIZE + 1},
+        {13 * CELL_SIZE + 1, 6 * CELL_SIZE + 1},
+        {13 * CELL_SIZE + 1, CELL_SIZE + 1}};
+
     SDL_SetRenderDrawColor(renderer, r, g, b, a);
 
     // draw 2 10 x 10 grids
-    for (int i = 1; i < 12; i++)
-    {
-        // top grid
-        SDL_RenderDrawLine(renderer, CELL_SIZE + 1, i * CELL_SIZE + 1, CELL_SIZE * 11 + 1, i * CELL_SIZE + 1); // horizontal lines
-        SDL_RenderDrawLine(renderer, i * CELL_SIZE + 1, CELL_SIZE + 1, i * CELL_SIZE + 1, CELL_SIZE * 11 + 1); // vertical lines
+    n = gridStrip(grid, 1, 1, BOARD_SIZE); // top grid
+    SDL_RenderDrawLines(renderer, grid, n);
+    n = gridStrip(grid, 1, 12, BOARD_SIZE); // bottom grid
+    SDL_RenderDrawLines(renderer, grid, n);
 
-        // bottom grid
-        SDL_RenderDrawLine(renderer, CELL_SIZE + 1, (i + 11) * CELL_SIZE + 1, CELL_SIZE * 11 + 1, (i + 11) * CELL_SIZE + 1);
-        SDL_RenderDrawLine(renderer, i * CELL_SIZE + 1, CELL_SIZE * 12 + 1, i * CELL_SIZE + 1, CELL_SIZE * 22 + 1);
-    }
+    SDL_RenderDrawLines(renderer, divider, sizeof(divider) / sizeof(divider[0]));
+    SDL_RenderDrawLines(renderer, selection, sizeof(selection) / sizeof(selection[0]));
+}
 
-    // draw vertical dividing line
-    SDL_RenderDrawLine(renderer, 12 * CELL_SIZE + 1, 0, 12 * CELL_SIZE + 1, CELL_SIZE * BOARD_SIZE_Y + 1);
+// fill display grid of p's boards from ships and shots, the engine keeps no grid of its own
+// top board has p's ships under opponent's hits on them, bottom board has p's misses and hits,
+// ships not placed yet are in ship selection area
+void fillGrid(int grid[BOARD_SIZE_X][BOARD_SIZE_Y], player *p, player *opponent)
+{
+    int dx, dy, x, y, cell, shot;
+    ship *s;
 
-    // draw selection box
-    SDL_RenderDrawLine(renderer, 13 * CELL_SIZE + 1, CELL_SIZE + 1, 18 * CELL_SIZE + 1, CELL_SIZE + 1);         // top
-    SDL_RenderDrawLine(renderer, 13 * CELL_SIZE + 1, 6 * CELL_SIZE + 1, 18 * CELL_SIZE + 1, 6 * CELL_SIZE + 1); // bottom
-    SDL_RenderDrawLine(renderer, 13 * CELL_SIZE + 1, CELL_SIZE + 1, 13 * CELL_SIZE + 1, 6 * CELL_SIZE + 1);     // left
-    SDL_RenderDrawLine(renderer, 18 * CELL_SIZE + 1, CELL_SIZE + 1, 18 * CELL_SIZE + 1, 6 * CELL_SIZE + 1);     // right
+    for (int i = 0; i < BOARD_SIZE_X; i++)
+    {
+        for (int j = 0; j < BOARD_SIZE_Y; j++)
+            grid[i][j] = 0;
+    }
+
+    // only rules that fit display grid are drawn, so boards are 10 x 10
+    for (y = 1; y <= BOARD_SIZE; y++)
+    {
+        for (x = 1; x <= BOARD_SIZE; x++)
+        {
+            cell = cellIndex(p, x, y);
+            shot = shotAt(p, cell);
+            if (shot)
+                grid[x][y + BOARD_SIZE + 1] = (shot == SHOT_HIT) ? 3 : 2;
+            if (shotAt(opponent, cell) == SHOT_HIT)
+                grid[x][y] = 3;
+        }
+    }
 
-    // message box
-    SDL_RenderDrawLine(renderer, 0, CELL_SIZE * BOARD_SIZE_Y + 1, CELL_SIZE * BOARD_SIZE_X + 1, CELL_SIZE * BOARD_SIZE_Y + 1);
+    for (int i = 0; i < p->nships; i++)
+    {
+        s = &p->ships[i];
+        shipDirection(s->rot, &dx, &dy);
+        for (int j = 0; j < s->len; j++)
+        {
+            x = s->x + (j - s->center) * dx;
+            y = s->y + (j - s->center) * dy;
+            if (grid[x][y] == 0)
+                grid[x][y] = 1;
+        }
+    }
 }
 
 // color in non-zero grid values corresponding to status
-void drawPlayerShips(SDL_Renderer *renderer, player *p)
+// cells are grouped by color so each color is one SDL_RenderFillRects call
+void drawPlayerShips(SDL_Renderer *renderer, int grid[BOARD_SIZE_X][BOARD_SIZE_Y])
 {
+    static const SDL_Color colors[3] = {
+        {22, 198, 12, 255},   // player's ship- green
+        {255, 255, 255, 255}, // miss- white
+        {197, 15, 31, 255}};  // hit- red
+    SDL_Rect rects[3][BOARD_SIZE_X * BOARD_SIZE_Y];
+    int counts[3] = {0, 0, 0}, c;
+
     for (int i = 0; i < BOARD_SIZE_X; i++)
     {
         for (int j = 0; j < BOARD_SIZE_Y; j++)
         {
-            switch (p->grid[i][j])
-            {
-            case 1:
-                SDL_SetRenderDrawColor(renderer, 22, 198, 12, 255); // player's ship- green
-                break;
-            case 2:
-                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // miss- white
-                break;
-            case 3:
-                SDL_SetRenderDrawColor(renderer, 197, 15, 31, 255); // hit- red
-                break;
-            default:
+            if (grid[i][j] < 1 || grid[i][j] > 3)
                 continue;
-            }
-            SDL_Rect rect = {i * CELL_SIZE + 2, j * CELL_SIZE + 2, CELL_SIZE - 1, CELL_SIZE - 1};
-            SDL_RenderFillRect(renderer, &rect);
+            c = grid[i][j] - 1;
+            rects[c][counts[c]++] = (SDL_Rect){i * CELL_SIZE + 2, j * CELL_SIZE + 2, CELL_SIZE - 1, CELL_SIZE - 1};
         }
     }
+
+    for (c = 0; c < 3; c++)
+    {
+        if (counts[c] == 0)
+            continue;
+        SDL_SetRenderDrawColor(renderer, colors[c].r, colors[c].g, colors[c].b, colors[c].a);
+        SDL_RenderFillRects(renderer, rects[c], counts[c]);
+    }
 }
 
-// create texture of each ship's number to display on ship
-void createNumberTextures(SDL_Renderer *renderer, player *p)
+// copy each ship's number from atlas onto first cell of ship
+void drawShipNumbers(SDL_Renderer *renderer, renderCache *cache, player *p)
 {
-    TTF_Font *font = TTF_OpenFont("FreeMonoBold.ttf", 25); // select font from file
-    SDL_Color color = {255, 255, 255};                     // color text white
-    SDL_Texture *texture;                                  // texture for rendering text
-
-    // surfaces for each ship's text
-    SDL_Surface *surfaces[5] = {
-        TTF_RenderText_Solid(font, "1", color), // ship selection numbers
-        TTF_RenderText_Solid(font, "2", color),
-        TTF_RenderText_Solid(font, "3", color),
-        TTF_RenderText_Solid(font, "4", color),
-        TTF_RenderText_Solid(font, "5", color)};
+    SDL_Rect numberRect = {0, 0, 13, 25}; // rectangle for copying number texture
+    ship *s;
+    int dx, dy;
 
     for (int i = 0; i < NSHIPS; i++)
     {
-        texture = SDL_CreateTextureFromSurface(renderer, surfaces[i]);    // create texture from surface w/ number text
-        SDL_RenderCopy(renderer, texture, NULL, &p->ships[i].numberRect); // copy texture to rendering target in ship's numberRect
-        SDL_FreeSurface(surfaces[i]);                                     // free surface's memory after texture created from surface is copied to renderer
-    }
+        // position number on first cell of ship
+        s = &p->ships[i];
+        shipDirection(s->rot, &dx, &dy);
+        numberRect.x = (s->x - s->center * dx) * CELL_SIZE + 2;
+        numberRect.y = (s->y - s->center * dy) * CELL_SIZE + 2;
 
-    // free texture memory, close font
-    SDL_DestroyTexture(texture);
-    TTF_CloseFont(font);
+        SDL_RenderCopy(renderer, cache->atlas, &cache->numbers[i], &numberRect);
+    }
 }
 
 // displays player's messages at bottom of window
-void displayMessage(SDL_Renderer *renderer, player *p)
+void displayMessage(SDL_Renderer *renderer, renderCache *cache, player *p)
 {
-    TTF_Font *font = TTF_OpenFont("FreeMonoBold.ttf", 25);                     // select font from file
-    SDL_Color color = {255, 255, 255};                                         // color text white
-    SDL_Surface *surface = TTF_RenderText_Solid(font, message(p->msg), color); // surface for message text
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);    // texture for rendering text
+    SDL_Rect *src, msgRect;
 
-    // determine size of rectangle
-    const char *msg = message(p->msg);
-    int len = (p->msg == 5 || p->msg == 6) ? 5 * 13 : (sizeof(msg) / sizeof(msg[0]) - 1) * 30;
+    if (p->msg < 0 || p->msg >= NMESSAGES)
+        return;
+    src = &cache->messages[p->msg];
 
     // area of rendering to display message
-    // centered using msg len
-    SDL_Rect msgRect = {((CELL_SIZE * BOARD_SIZE_X + 1) / 2) - len / 2, CELL_SIZE * (BOARD_SIZE_Y + 1) + 1, len, 25};
+    // centered using width of rendered msg
+    msgRect = (SDL_Rect){((CELL_SIZE * BOARD_SIZE_X + 1) / 2) - src->w / 2, CELL_SIZE * (BOARD_SIZE_Y + 1) + 1, src->w, src->h};
 
-    // copy texture to message box area in rendering
-    SDL_RenderCopy(renderer, texture, NULL, &msgRect);
-
-    // free texture and surface memory, close font
-    SDL_DestroyTexture(texture);
-    SDL_FreeSurface(surface);
-    TTF_CloseFont(font);
+    // copy msg from atlas to message box area in rendering
+    SDL_RenderCopy(renderer, cache->atlas, src, &msgRect);
 }
 /********************************************************************/
 
-// display objects in window
-void render(SDL_Renderer *renderer, player *p)
+// background and grid lines
+void drawStaticLayer(SDL_Renderer *renderer)
 {
     SDL_Color gridBackground = {22, 22, 22, 255}; // almost black
     SDL_Color gridLineColor = {44, 44, 44, 255};  // dark grey
 
-    // draw objects
     drawBackground(renderer, gridBackground.r, gridBackground.g, gridBackground.b, gridBackground.a);
     drawGrids(renderer, gridLineColor.r, gridLineColor.g, gridLineColor.b, gridLineColor.a);
-    drawPlayerShips(renderer, p);
-    createNumberTextures(renderer, p);
-    displayMessage(renderer, p);
+}
+
+// display objects in window, p's boards w/ opponent's hits on p's ships
+// only redraws and presents if player's board changed or another player's board was shown last
+void render(SDL_Renderer *renderer, renderCache *cache, player *p, player *opponent)
+{
+    int grid[BOARD_SIZE_X][BOARD_SIZE_Y];
+
+    if (!p->dirty && cache->shown == p)
+        return;
+
+    // draw objects
+    if (cache->staticLayer)
+        SDL_RenderCopy(renderer, cache->staticLayer, NULL, NULL);
+    else
+        drawStaticLayer(renderer);
+    fillGrid(grid, p, opponent);
+    drawPlayerShips(renderer, grid);
+    drawShipNumbers(renderer, cache, p);
+    displayMessage(renderer, cache, p);
 
     // render objects
     SDL_RenderPresent(renderer);
-    SDL_RenderClear(renderer);
+    p->dirty = false;
+    cache->shown = p;
 }
 
 /*********************************************************************
-*********************************************************************/
\ No newline at end of file
+*********************************************************************/
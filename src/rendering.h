@@ -1,9 +1,54 @@
 #ifndef __RENDERING_H__
 #define __RENDERING_H__
 
+#include <stdbool.h>
 #include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
 #include "engine.h"
 
+#define CELL_SIZE 36
+#define WINDOW_WIDTH (CELL_SIZE * BOARD_SIZE_X + 1)
+#define WINDOW_HEIGHT (CELL_SIZE * (BOARD_SIZE_Y + 3) + 1) // boards and message box
+
+#define FPS 100
+#define TIMESTEP (1.0 / FPS) // seconds of game time per update
+#define MAX_UPDATES 10       // most updates to catch up on at once before dropping time
+
+#define INPUT_QUEUE_SIZE 64 // events buffered per frame, power of 2
+
+#define FONT_FILE "FreeMonoBold.ttf"
+#define FONT_SIZE 25
+
+// textures and fonts created once at startup and reused every frame
+typedef struct
+{
+    TTF_Font *font;
+    SDL_Texture *atlas;           // ship numbers and every message, one per row
+    SDL_Rect numbers[NSHIPS];     // area of each ship's number in atlas
+    SDL_Rect messages[NMESSAGES]; // area of each message in atlas
+    SDL_Texture *staticLayer;     // background and grid lines, NULL if renderer can't draw to textures
+    player *shown;                // player whose board was last presented
+} renderCache;
+
+// events taken from SDL's queue, handled in order they arrived
+typedef struct
+{
+    SDL_Event events[INPUT_QUEUE_SIZE];
+    unsigned head, tail; // next event to read and next slot to write, wrap around buffer
+} inputQueue;
+
+// SDL abstractions
+SDL_Renderer *initializeSDL(SDL_Window *window, const char *title, int width, int height);
+void teardown(SDL_Renderer *renderer, SDL_Window *window, renderCache *cache);
+double getTime(void);
+void initializeInput(inputQueue *q);
+bool waitInput(inputQueue *q, double timeout);
+bool nextInput(inputQueue *q, SDL_Event *event);
+
+// render resources
+int createRenderCache(SDL_Renderer *renderer, renderCache *cache, int width, int height);
+void destroyRenderCache(renderCache *cache);
+
 /* Render Game
 **********************************************************************
 *********************************************************************/
@@ -12,11 +57,14 @@
 *********************************************************************/
 void drawBackground(SDL_Renderer *renderer, int r, int g, int b, int a);
 void drawGrids(SDL_Renderer *renderer, int r, int g, int b, int a);
-void drawPlayerShips(SDL_Renderer *renderer, player *p);
-void createNumberTextures(SDL_Renderer *renderer, player *p);
+void drawStaticLayer(SDL_Renderer *renderer);
+void fillGrid(int grid[BOARD_SIZE_X][BOARD_SIZE_Y], player *p, player *opponent);
+void drawPlayerShips(SDL_Renderer *renderer, int grid[BOARD_SIZE_X][BOARD_SIZE_Y]);
+void drawShipNumbers(SDL_Renderer *renderer, renderCache *cache, player *p);
+void displayMessage(SDL_Renderer *renderer, renderCache *cache, player *p);
 /********************************************************************/
 
-void render(SDL_Renderer *renderer, player *p);
+void render(SDL_Renderer *renderer, renderCache *cache, player *p, player *opponent);
 
 /*********************************************************************
 *********************************************************************/
@@ -0,0 +1,360 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "replay.h"
+
+#define MIN_OFFSETS 1024 // game offsets a corpus index starts w/ room for
+
+// append bytes to buffer, writing buffer to file first if they don't fit
+// len must be at most REPLAY_BUFFER_SIZE
+void writeBytes(replayWriter *w, const void *bytes, size_t len)
+{
+    if (w->len + len > REPLAY_BUFFER_SIZE)
+        flushReplay(w);
+    memcpy(w->buf + w->len, bytes, len);
+    w->len += len;
+}
+
+// read varint no larger than max as an int
+// returns 0 on success, 1 if data ends first or value is too large
+int readInt(const unsigned char *data, size_t size, size_t *pos, uint64_t max, int *value)
+{
+    uint64_t v;
+
+    if (readVarint(data, size, pos, &v) || v > max)
+        return 1;
+    *value = v;
+    return 0;
+}
+
+/* Replay Writer
+*********************************************************************/
+void initializeReplayWriter(replayWriter *w, FILE *file)
+{
+    w->file = file;
+    w->len = 0;
+    w->failed = false;
+}
+
+// write buffered records to file
+// returns 0 on success, 1 if this or an earlier write failed
+int flushReplay(replayWriter *w)
+{
+    if (!w->failed && w->len && fwrite(w->buf, 1, w->len, w->file) != w->len)
+        w->failed = true;
+    w->len = 0;
+    return w->failed;
+}
+
+void writeVarint(replayWriter *w, uint64_t value)
+{
+    if (w->len + MAX_VARINT_LEN > REPLAY_BUFFER_SIZE)
+        flushReplay(w);
+    while (value >= 0x80)
+    {
+        w->buf[w->len++] = value | 0x80;
+        value >>= 7;
+    }
+    w->buf[w->len++] = value;
+}
+
+// start record of game w/ both fleets placed, before its first shot
+// returns 0 on success, 1 if a ship isn't on board or a write failed
+int writeReplayHeader(replayWriter *w, game *g)
+{
+    const char *name;
+    unsigned char version = REPLAY_VERSION;
+    size_t len;
+    ship *s;
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < g->rules.nships; j++)
+        {
+            if (g->players[i].ships[j].cells[0] < 0)
+                return 1;
+        }
+    }
+
+    writeBytes(w, REPLAY_MAGIC, 4);
+    writeBytes(w, &version, 1);
+    writeVarint(w, g->seed);
+
+    writeVarint(w, g->rules.width);
+    writeVarint(w, g->rules.height);
+    writeVarint(w, g->rules.nships);
+    for (int i = 0; i < g->rules.nships; i++)
+        writeVarint(w, g->rules.lens[i]);
+
+    for (int i = 0; i < 2; i++)
+    {
+        name = (g->strategies[i] != NULL) ? g->strategies[i]->name : "";
+        len = strlen(name);
+        if (len > REPLAY_NAME_LEN)
+            len = REPLAY_NAME_LEN;
+        writeVarint(w, len);
+        writeBytes(w, name, len);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < g->rules.nships; j++)
+        {
+            s = &g->players[i].ships[j];
+            writeVarint(w, (uint64_t)s->cells[s->center] * 4 + s->rot);
+        }
+    }
+    return w->failed;
+}
+
+// record shot game's last turn took, call after each shot fireShot() or computerShot() took
+// returns 0 on success, 1 if a write failed
+int writeReplayShot(replayWriter *w, game *g)
+{
+    writeVarint(w, g->players[(g->turn + 1) % 2].lastShot + 1);
+    return w->failed;
+}
+
+// end record of game, once it's over or if it's abandoned
+// returns 0 on success, 1 if a write failed
+int writeReplayEnd(replayWriter *w)
+{
+    writeVarint(w, 0);
+    return w->failed;
+}
+/********************************************************************/
+
+/* Replay Engine
+*********************************************************************/
+// read varint at pos of data and move pos past it
+// returns 0 on success, 1 if data ends first or varint is longer than 64 bits
+int readVarint(const unsigned char *data, size_t size, size_t *pos, uint64_t *value)
+{
+    uint64_t v = 0;
+
+    for (int shift = 0; shift < 64 && *pos < size; shift += 7)
+    {
+        v |= (uint64_t)(data[*pos] & 0x7F) << shift;
+        if (!(data[(*pos)++] & 0x80))
+        {
+            *value = v;
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// read header of game record at pos of data and move pos to its first shot
+// returns 0 on success, 1 if header is cut off or isn't a valid game setup
+int readReplayHeader(const unsigned char *data, size_t size, size_t *pos, replayHeader *h)
+{
+    int len, cells;
+
+    if (size - *pos < 5 || memcmp(data + *pos, REPLAY_MAGIC, 4) || data[*pos + 4] != REPLAY_VERSION)
+        return 1;
+    *pos += 5;
+    if (readVarint(data, size, pos, &h->seed))
+        return 1;
+
+    // bound every number before using it so a corrupt log can't overrun the header
+    if (readInt(data, size, pos, MAX_OCEAN_SIZE, &h->rules.width) || readInt(data, size, pos, MAX_OCEAN_SIZE, &h->rules.height) ||
+        readInt(data, size, pos, MAX_SHIPS, &h->rules.nships))
+        return 1;
+    for (int i = 0; i < h->rules.nships; i++)
+    {
+        if (readInt(data, size, pos, MAX_SHIP_LEN, &len))
+            return 1;
+        h->rules.lens[i] = len;
+    }
+    if (checkRules(&h->rules))
+        return 1;
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (readInt(data, size, pos, REPLAY_NAME_LEN, &len) || size - *pos < len)
+            return 1;
+        memcpy(h->strategies[i], data + *pos, len);
+        h->strategies[i][len] = '\0';
+        *pos += len;
+    }
+
+    cells = h->rules.width * h->rules.height;
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < h->rules.nships; j++)
+        {
+            if (readInt(data, size, pos, (uint64_t)cells * 4 - 1, &h->fleets[i][j]))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+// set up game from header of game record at pos of data and move pos to its first shot
+// game must be from createGame()
+// returns 0 on success, 1 if header is cut off, corrupt, has a ship the engine rejects, or memory ran out
+int startReplay(game *g, const unsigned char *data, size_t size, size_t *pos, replayHeader *h)
+{
+    const strategy *st;
+    int cell;
+
+    if (readReplayHeader(data, size, pos, h) || initializeGame(g, &h->rules))
+        return 1;
+
+    seedGame(g, h->seed);
+    for (int i = 0; i < 2; i++)
+    {
+        st = findStrategy(h->strategies[i]);
+        if (st != NULL)
+            setStrategy(g, i, st);
+        for (int j = 0; j < h->rules.nships; j++)
+        {
+            cell = h->fleets[i][j] / 4;
+            if (placeShip(g, i, j, cell % h->rules.width + 1, cell / h->rules.width + 1, h->fleets[i][j] % 4))
+                return 1;
+        }
+    }
+    return beginGame(g);
+}
+
+// take next shot of game record at pos of data through the engine and move pos past it
+// engine resolves shot again, rejecting any shot off board, repeated, or after game is over
+// returns same results as fireShot(), 0 once record ends, -1 if record is cut off or engine rejects shot
+int replayShot(game *g, const unsigned char *data, size_t size, size_t *pos)
+{
+    uint64_t shot;
+    int width = g->rules.width, result;
+
+    // most shots fit in 1 byte, read those w/o a call
+    if (*pos < size && data[*pos] < 0x80)
+        shot = data[(*pos)++];
+    else if (readVarint(data, size, pos, &shot))
+        return -1;
+    if (shot == 0)
+        return 0;
+
+    if (shot > width * g->rules.height)
+        return -1;
+    result = fireShot(g, (shot - 1) % width + 1, (shot - 1) / width + 1);
+    return result ? result : -1;
+}
+
+// re-run game record at pos of data through the engine and move pos past it
+// game must be from createGame(), it's left as the record leaves it, over unless record was abandoned
+// returns 0 on success, 1 if record is cut off, corrupt, or has a ship or shot the engine rejects
+int replayGame(game *g, const unsigned char *data, size_t size, size_t *pos, replayHeader *h)
+{
+    int result;
+
+    if (startReplay(g, data, size, pos, h))
+        return 1;
+    while ((result = replayShot(g, data, size, pos)) > 0)
+        ;
+    return result < 0;
+}
+
+// move pos past game record at pos of data w/o replaying it
+// shots are never 0 and written as shortest varints, so record ends at its first 0 byte after header
+// returns 0 on success, 1 if record is cut off or header is corrupt
+int skipReplayGame(const unsigned char *data, size_t size, size_t *pos, replayHeader *h)
+{
+    const unsigned char *end;
+
+    if (readReplayHeader(data, size, pos, h))
+        return 1;
+    end = memchr(data + *pos, 0, size - *pos);
+    if (end == NULL)
+        return 1;
+    *pos = end - data + 1;
+    return 0;
+}
+/********************************************************************/
+
+/* Replay Corpus
+*********************************************************************/
+// map replay log at path into memory and index offset of every game record w/o copying it
+// indexing stops at first record that's cut off or corrupt, see indexed
+// returns 0 on success, 1 if file can't be mapped or memory ran out
+int openReplayCorpus(replayCorpus *c, const char *path)
+{
+    struct stat st;
+    replayHeader *h;
+    size_t *offsets, pos = 0, capacity = MIN_OFFSETS;
+    int fd = open(path, O_RDONLY);
+
+    c->data = NULL;
+    c->size = 0;
+    c->offsets = NULL;
+    c->games = 0;
+    c->indexed = 0;
+    if (fd < 0)
+        return 1;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    // mapping stays valid once file is closed, pages are read in on first touch
+    c->size = st.st_size;
+    if (c->size > 0)
+    {
+        c->data = mmap(NULL, c->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (c->data == MAP_FAILED)
+            c->data = NULL;
+    }
+    close(fd);
+    if (c->size > 0 && c->data == NULL)
+        return 1;
+    if (c->data != NULL)
+        posix_madvise((void *)c->data, c->size, POSIX_MADV_SEQUENTIAL);
+
+    h = malloc(sizeof(replayHeader));
+    c->offsets = malloc(capacity * sizeof(size_t));
+    if (h == NULL || c->offsets == NULL)
+    {
+        free(h);
+        closeReplayCorpus(c);
+        return 1;
+    }
+    while (pos < c->size)
+    {
+        if (c->games == capacity)
+        {
+            capacity *= 2;
+            offsets = realloc(c->offsets, capacity * sizeof(size_t));
+            if (offsets == NULL)
+            {
+                free(h);
+                closeReplayCorpus(c);
+                return 1;
+            }
+            c->offsets = offsets;
+        }
+        c->offsets[c->games] = pos;
+        if (skipReplayGame(c->data, c->size, &pos, h))
+            break;
+        c->games++;
+        c->indexed = pos;
+    }
+    free(h);
+    return 0;
+}
+
+void closeReplayCorpus(replayCorpus *c)
+{
+    if (c->data != NULL)
+        munmap((void *)c->data, c->size);
+    free(c->offsets);
+    c->data = NULL;
+    c->size = 0;
+    c->offsets = NULL;
+    c->games = 0;
+    c->indexed = 0;
+}
+/********************************************************************/
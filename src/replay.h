@@ -0,0 +1,88 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "game.h"
+
+/*
+Replay log format
+
+Every number is an unsigned LEB128 varint, 7 bits per byte from the lowest,
+high bit set on every byte but the last. A log is any number of games back to back:
+
+magic      4 bytes, "BSRP"
+version    1 byte, REPLAY_VERSION
+seed       game's seed, see seedGame()
+rules      width, height, nships, then length of each ship
+strategies name length then name of each player's strategy, length 0 if player has none
+fleets     center cell * 4 + rotation of each ship of player 0, then of player 1, see cellIndex()
+shots      cell + 1 of each shot, players take turns starting w/ player 0
+end        0
+
+Every shot on a board of up to 127 cells, like the standard 10 x 10 board, takes 1 byte.
+*/
+
+#define REPLAY_MAGIC "BSRP"
+#define REPLAY_VERSION 1
+#define REPLAY_BUFFER_SIZE 65536 // bytes writer buffers before writing to its file
+#define REPLAY_NAME_LEN 15       // longest strategy name stored in a log
+#define MAX_VARINT_LEN 10        // bytes of the longest varint of a 64 bit number
+
+// streaming writer of a replay log, buffers records so shots cost no allocation or system call
+typedef struct
+{
+    FILE *file;
+    size_t len;  // bytes buffered
+    bool failed; // a write to file failed, every later write is dropped
+    unsigned char buf[REPLAY_BUFFER_SIZE];
+} replayWriter;
+
+// game setup read from a replay log's header
+typedef struct
+{
+    uint64_t seed;
+    rules rules;
+    char strategies[2][REPLAY_NAME_LEN + 1]; // empty if player had no strategy
+    int fleets[2][MAX_SHIPS];                // center cell * 4 + rotation of each ship of each player
+} replayHeader;
+
+// replay log mapped read only into memory, w/ offset of each game record
+typedef struct
+{
+    const unsigned char *data;
+    size_t size;
+    size_t *offsets; // start of each game record in data
+    long games;      // game records indexed
+    size_t indexed;  // bytes of data indexed, less than size if a record is cut off or corrupt
+} replayCorpus;
+
+/* Replay Writer
+*********************************************************************/
+void initializeReplayWriter(replayWriter *w, FILE *file);
+int flushReplay(replayWriter *w);
+void writeVarint(replayWriter *w, uint64_t value);
+int writeReplayHeader(replayWriter *w, game *g);
+int writeReplayShot(replayWriter *w, game *g);
+int writeReplayEnd(replayWriter *w);
+/********************************************************************/
+
+/* Replay Engine
+*********************************************************************/
+int readVarint(const unsigned char *data, size_t size, size_t *pos, uint64_t *value);
+int readReplayHeader(const unsigned char *data, size_t size, size_t *pos, replayHeader *h);
+int startReplay(game *g, const unsigned char *data, size_t size, size_t *pos, replayHeader *h);
+int replayShot(game *g, const unsigned char *data, size_t size, size_t *pos);
+int replayGame(game *g, const unsigned char *data, size_t size, size_t *pos, replayHeader *h);
+int skipReplayGame(const unsigned char *data, size_t size, size_t *pos, replayHeader *h);
+/********************************************************************/
+
+/* Replay Corpus
+*********************************************************************/
+int openReplayCorpus(replayCorpus *c, const char *path);
+void closeReplayCorpus(replayCorpus *c);
+/********************************************************************/
+
+#endif
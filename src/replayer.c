@@ -0,0 +1,342 @@
+/*
+Battleship replay engine and corpus analytics
+
+Maps a replay log into memory, indexes its games w/o copying them and
+re-runs every game through the engine on every core w/o rendering.
+Each recorded ship and shot must be one the engine accepts, so a corrupt
+record or one that doesn't match the engine is counted as invalid.
+
+Reports shots resolved per second, win rates of each strategy, the number
+of shots winners took, and a heatmap of where each player first hit a ship.
+Shot and heatmap statistics only count games on the board of the log's first game.
+
+Usage: battleship-replay [replay] [threads]
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "replay.h"
+
+#define MAX_STRATEGY_STATS 32 // distinct strategy names tracked, games of any others aren't counted by strategy
+#define MAX_HEATMAP_WIDTH 32  // widest board heatmap is printed as a grid for, most hit cells are listed otherwise
+#define TOP_CELLS 10          // cells listed for boards too wide for a grid
+
+// games of one strategy and their results
+typedef struct
+{
+    char name[REPLAY_NAME_LEN + 1];
+    long games, wins;
+    long winShots; // shots taken in games won
+} strategyStats;
+
+// results of games replayed by one worker thread
+typedef struct
+{
+    pthread_t thread;
+    const replayCorpus *corpus;
+    long first, count; // replay games first to first + count - 1
+    int width, height; // board shot and heatmap statistics count games on
+    long invalid, unfinished, shots;
+    long onBoard;      // games on board
+    long *firstHits;   // first hits of either player on each cell of board
+    long *shotsToWin;  // games on board won, by number of shots taken by winner, one count per cell of board and 0
+    strategyStats strategies[MAX_STRATEGY_STATS];
+    int nstrategies;
+} replayWorker;
+
+// stats of strategy w/ given name, added if not tracked yet
+// returns NULL if too many strategies are tracked already
+strategyStats *findStrategyStats(strategyStats *stats, int *nstats, const char *name)
+{
+    for (int i = 0; i < *nstats; i++)
+    {
+        if (!strcmp(stats[i].name, name))
+            return &stats[i];
+    }
+    if (*nstats == MAX_STRATEGY_STATS)
+        return NULL;
+
+    stats = &stats[(*nstats)++];
+    strcpy(stats->name, name);
+    stats->games = 0;
+    stats->wins = 0;
+    stats->winShots = 0;
+    return stats;
+}
+
+// replay worker's range of games, collecting their statistics
+void *runWorker(void *arg)
+{
+    replayWorker *w = arg;
+    const replayCorpus *c = w->corpus;
+    replayHeader *h = malloc(sizeof(replayHeader));
+    game *g = createGame(NULL);
+    strategyStats *st;
+    size_t pos;
+    int result, shooter, winner, firstHit[2];
+    bool onBoard;
+
+    if (h == NULL || g == NULL)
+    {
+        free(h);
+        if (g != NULL)
+            destroyGame(g);
+        w->invalid = w->count;
+        return NULL;
+    }
+
+    for (long i = w->first; i < w->first + w->count; i++)
+    {
+        pos = c->offsets[i];
+        if (startReplay(g, c->data, c->size, &pos, h))
+        {
+            w->invalid++;
+            continue;
+        }
+
+        // resolve every shot through the engine, noting each player's first hit
+        firstHit[0] = firstHit[1] = -1;
+        while ((result = replayShot(g, c->data, c->size, &pos)) > 0)
+        {
+            shooter = (g->turn + 1) % 2;
+            if (result > 1 && firstHit[shooter] < 0)
+                firstHit[shooter] = g->players[shooter].lastShot;
+        }
+        if (result < 0)
+        {
+            w->invalid++;
+            continue;
+        }
+
+        w->shots += g->players[0].shotsTaken + g->players[1].shotsTaken;
+        winner = gameWinner(g);
+        if (winner < 0)
+            w->unfinished++;
+        onBoard = g->rules.width == w->width && g->rules.height == w->height;
+        if (onBoard)
+        {
+            w->onBoard++;
+            if (winner >= 0)
+                w->shotsToWin[g->players[winner].shotsTaken]++;
+        }
+
+        for (int p = 0; p < 2; p++)
+        {
+            if (onBoard && firstHit[p] >= 0)
+                w->firstHits[firstHit[p]]++;
+            st = findStrategyStats(w->strategies, &w->nstrategies, h->strategies[p]);
+            if (st == NULL)
+                continue;
+            st->games++;
+            if (winner == p)
+            {
+                st->wins++;
+                st->winShots += g->players[p].shotsTaken;
+            }
+        }
+    }
+
+    free(h);
+    destroyGame(g);
+    return NULL;
+}
+
+// wall clock time in seconds
+double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+// print share of first hits on each cell of board, as a grid on narrow boards
+// or as the most hit cells on wide ones
+void printHeatmap(const long *firstHits, int width, int height)
+{
+    long total = 0, best;
+    int cells = width * height, top;
+    bool *listed;
+
+    for (int i = 0; i < cells; i++)
+        total += firstHits[i];
+    if (total == 0)
+        return;
+
+    if (width <= MAX_HEATMAP_WIDTH)
+    {
+        printf("\nfirst hits, per mille of all first hits by cell\n");
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+                printf("%4.0f", 1000.0 * firstHits[y * width + x] / total);
+            printf("\n");
+        }
+        return;
+    }
+
+    listed = calloc(cells, sizeof(bool));
+    if (listed == NULL)
+        return;
+    printf("\nfirst hits, most hit cells\n");
+    for (int n = 0; n < TOP_CELLS; n++)
+    {
+        top = -1;
+        best = 0;
+        for (int i = 0; i < cells; i++)
+        {
+            if (!listed[i] && firstHits[i] > best)
+            {
+                top = i;
+                best = firstHits[i];
+            }
+        }
+        if (top < 0)
+            break;
+        listed[top] = true;
+        printf("%4d,%-4d  %6.3f%% (%ld)\n", top % width + 1, top / width + 1, 100.0 * best / total, best);
+    }
+    free(listed);
+}
+
+int main(int argc, char *argv[])
+{
+    long threads = (argc > 2) ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    long invalid = 0, unfinished = 0, shots = 0, onBoard = 0, *firstHits, *shotsToWin, bucket;
+    int width, height, cells, range, nstrategies = 0, status;
+    strategyStats strategies[MAX_STRATEGY_STATS], *st;
+    replayHeader *h = malloc(sizeof(replayHeader));
+    replayCorpus c;
+    replayWorker *workers;
+    size_t pos = 0;
+    double start, indexed, seconds;
+
+    if (argc < 2 || threads < 1)
+    {
+        printf("Usage: %s [replay] [threads]\n", argv[0]);
+        return 1;
+    }
+    if (h == NULL)
+        return 1;
+
+    start = now();
+    if (openReplayCorpus(&c, argv[1]))
+    {
+        printf("Can't read %s\n", argv[1]);
+        return 1;
+    }
+    indexed = now() - start;
+    if (c.games == 0)
+    {
+        printf("%s has no valid games\n", argv[1]);
+        return 1;
+    }
+
+    // shot and heatmap statistics are kept for board of first game
+    readReplayHeader(c.data, c.size, &pos, h);
+    width = h->rules.width;
+    height = h->rules.height;
+    cells = width * height;
+    free(h);
+    if (threads > c.games)
+        threads = c.games;
+
+    workers = calloc(threads, sizeof(replayWorker));
+    firstHits = calloc(cells, sizeof(long));
+    shotsToWin = calloc(cells + 1, sizeof(long));
+    if (workers == NULL || firstHits == NULL || shotsToWin == NULL)
+        return 1;
+    for (long i = 0; i < threads; i++)
+    {
+        workers[i].firstHits = calloc(cells, sizeof(long));
+        workers[i].shotsToWin = calloc(cells + 1, sizeof(long));
+        if (workers[i].firstHits == NULL || workers[i].shotsToWin == NULL)
+            return 1;
+    }
+
+    // split games evenly between workers, each replays its games in place in the mapped log
+    start = now();
+    for (long i = 0; i < threads; i++)
+    {
+        workers[i].corpus = &c;
+        workers[i].first = c.games * i / threads;
+        workers[i].count = c.games * (i + 1) / threads - workers[i].first;
+        workers[i].width = width;
+        workers[i].height = height;
+        pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]);
+    }
+
+    // combine results of each worker
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        invalid += workers[i].invalid;
+        unfinished += workers[i].unfinished;
+        shots += workers[i].shots;
+        onBoard += workers[i].onBoard;
+        for (int n = 0; n < cells; n++)
+            firstHits[n] += workers[i].firstHits[n];
+        for (int n = 0; n <= cells; n++)
+            shotsToWin[n] += workers[i].shotsToWin[n];
+        for (int s = 0; s < workers[i].nstrategies; s++)
+        {
+            st = findStrategyStats(strategies, &nstrategies, workers[i].strategies[s].name);
+            if (st == NULL)
+                continue;
+            st->games += workers[i].strategies[s].games;
+            st->wins += workers[i].strategies[s].wins;
+            st->winShots += workers[i].strategies[s].winShots;
+        }
+        free(workers[i].firstHits);
+        free(workers[i].shotsToWin);
+    }
+    seconds = now() - start;
+    free(workers);
+
+    printf("games      %ld\n", c.games);
+    if (c.indexed < c.size)
+        printf("cut off    %zu bytes after last game, record is cut off or corrupt\n", c.size - c.indexed);
+    if (invalid)
+        printf("invalid    %ld games, corrupt or don't match the engine\n", invalid);
+    if (unfinished)
+        printf("unfinished %ld games\n", unfinished);
+    printf("threads    %ld\n", threads);
+    printf("bytes      %zu, %.2f per shot\n", c.size, shots ? (double)c.size / shots : 0);
+    printf("indexing   %.3f seconds\n", indexed);
+    printf("replaying  %.3f seconds\n", seconds);
+    printf("games/sec  %.1f\n", c.games / seconds);
+    printf("shots/sec  %.0f\n", shots / seconds);
+
+    printf("\nstrategy      games     wins  shots per win\n");
+    for (int s = 0; s < nstrategies; s++)
+        printf("%-8s %10ld  %6.2f%%  %13.2f\n", strategies[s].name[0] ? strategies[s].name : "(none)", strategies[s].games,
+               100.0 * strategies[s].wins / strategies[s].games, strategies[s].wins ? (double)strategies[s].winShots / strategies[s].wins : 0);
+
+    // share of games on board won in each range of shots, a tenth of board per range on larger boards
+    printf("\nboard      %dx%d, %ld games\n", width, height, onBoard);
+    range = (cells > 100) ? cells / 10 : 10;
+    printf("shots      wins\n");
+    for (int n = 0; n <= cells; n += range)
+    {
+        bucket = 0;
+        for (int i = n; i < n + range && i <= cells; i++)
+            bucket += shotsToWin[i];
+        if (bucket)
+            printf("%3d-%-3d   %7.2f%%\n", n, (n + range - 1 < cells) ? n + range - 1 : cells, 100.0 * bucket / onBoard);
+    }
+    printHeatmap(firstHits, width, height);
+
+    // fail if any game couldn't be replayed
+    status = invalid > 0 || c.indexed < c.size;
+    free(firstHits);
+    free(shotsToWin);
+    closeReplayCorpus(&c);
+    return status;
+}
@@ -0,0 +1,89 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stdint.h>
+
+// pseudo-random number generator state (xoshiro256**)
+// each computer player owns one so games don't share random state
+typedef struct
+{
+    uint64_t s[4];
+} rng;
+
+/* Random Numbers
+*********************************************************************/
+// next value of splitmix64 sequence, only used to expand seeds
+static inline uint64_t splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9e3779b97f4a7c15);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+// same seed always gives same sequence, any seed is valid
+static inline void rngSeed(rng *r, uint64_t seed)
+{
+    for (int i = 0; i < 4; i++)
+        r->s[i] = splitmix64(&seed); // never all zero
+}
+
+static inline uint64_t rngRotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+// next 64-bit random value
+static inline uint64_t rngNext(rng *r)
+{
+    uint64_t result = rngRotl(r->s[1] * 5, 7) * 9, t = r->s[1] << 17;
+
+    r->s[2] ^= r->s[0];
+    r->s[3] ^= r->s[1];
+    r->s[1] ^= r->s[2];
+    r->s[0] ^= r->s[3];
+    r->s[2] ^= t;
+    r->s[3] = rngRotl(r->s[3], 45);
+    return result;
+}
+
+// random value from 0 to bound - 1 w/o modulo bias, bound must be > 0
+// scales 32 random bits by bound and only redraws in the rare case the low half lands in the biased range
+static inline uint32_t rngBounded(rng *r, uint32_t bound)
+{
+    uint64_t m = (rngNext(r) >> 32) * bound;
+    uint32_t threshold;
+
+    if ((uint32_t)m < bound)
+    {
+        threshold = -bound % bound;
+        while ((uint32_t)m < threshold)
+            m = (rngNext(r) >> 32) * bound;
+    }
+    return m >> 32;
+}
+
+// fill out w/ count random values
+// state is kept in locals so the loop doesn't reload it through r every draw
+static inline void rngFill(rng *r, uint64_t *out, int count)
+{
+    rng local = *r;
+
+    for (int i = 0; i < count; i++)
+        out[i] = rngNext(&local);
+    *r = local;
+}
+
+// fill out w/ count random values from 0 to bound - 1, see rngBounded()
+static inline void rngFillBounded(rng *r, int *out, int count, uint32_t bound)
+{
+    rng local = *r;
+
+    for (int i = 0; i < count; i++)
+        out[i] = rngBounded(&local, bound);
+    *r = local;
+}
+/********************************************************************/
+
+#endif
@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include "engine.h"
+
+const rules standardRules = {BOARD_SIZE, BOARD_SIZE, NSHIPS, {5, 4, 3, 3, 2}};
+
+/* Rules
+*********************************************************************/
+// returns 0 if board fits and every ship fits on board w/ room for the whole fleet, 1 if not
+int checkRules(const rules *r)
+{
+    int cells = 0;
+
+    if (r->width < 1 || r->width > MAX_OCEAN_SIZE || r->height < 1 || r->height > MAX_OCEAN_SIZE)
+        return 1;
+    if (r->nships < 1 || r->nships > MAX_SHIPS)
+        return 1;
+    for (int i = 0; i < r->nships; i++)
+    {
+        if (r->lens[i] < 1 || r->lens[i] > MAX_SHIP_LEN || (r->lens[i] > r->width && r->lens[i] > r->height))
+            return 1;
+        cells += r->lens[i];
+    }
+    return cells > r->width * r->height;
+}
+
+// read rules from text like "20x20" for standard fleet on a 20 x 20 board,
+// or "50x50:5*4,4*6,3*10,2*10" for a fleet of lengths, each optionally repeated
+// returns 0 if text is valid rules, 1 if not
+// numbers are range checked before they're stored, so values too big for rules aren't truncated into valid ones
+int parseRules(const char *text, rules *r)
+{
+    char *end;
+    long width, height, len, count;
+
+    *r = standardRules;
+    width = strtol(text, &end, 10);
+    if (*end != 'x')
+        return 1;
+    height = strtol(end + 1, &end, 10);
+    if (width < 1 || width > MAX_OCEAN_SIZE || height < 1 || height > MAX_OCEAN_SIZE)
+        return 1;
+    r->width = width;
+    r->height = height;
+
+    if (*end == ':')
+    {
+        r->nships = 0;
+        do
+        {
+            len = strtol(end + 1, &end, 10);
+            count = 1;
+            if (*end == '*')
+                count = strtol(end + 1, &end, 10);
+            if (len < 1 || len > MAX_SHIP_LEN || count < 1 || count > MAX_SHIPS - r->nships)
+                return 1;
+            while (count-- > 0)
+                r->lens[r->nships++] = len;
+        } while (*end == ',');
+    }
+
+    if (*end != '\0')
+        return 1;
+    return checkRules(r);
+}
+
+// board is too big for per-cell arrays, so shots and ships are kept in cell maps
+bool sparseRules(const rules *r)
+{
+    return r->width > MAX_BOARD_SIZE || r->height > MAX_BOARD_SIZE;
+}
+
+// board is 10 x 10, so bitboard layers and fast paths are used
+bool bitboardRules(const rules *r)
+{
+    return r->width == BOARD_SIZE && r->height == BOARD_SIZE;
+}
+
+// board and fleet fit the SDL game's display grid and ship selection area
+bool displayRules(const rules *r)
+{
+    if (!bitboardRules(r) || r->nships > NSHIPS)
+        return false;
+    for (int i = 0; i < r->nships; i++)
+    {
+        if (r->lens[i] > MAX_STAGED_LEN)
+            return false;
+    }
+    return true;
+}
+/********************************************************************/
@@ -0,0 +1,32 @@
+#ifndef __RULES_H__
+#define __RULES_H__
+
+#include <stdbool.h>
+
+#define MAX_BOARD_SIZE 64                             // largest width or height of a board kept in per-cell arrays
+#define MAX_CELLS (MAX_BOARD_SIZE * MAX_BOARD_SIZE)  // most cells on a board kept in per-cell arrays
+#define MAX_OCEAN_SIZE 1000                           // largest width or height of a sparse board
+#define MAX_SHIPS 500                                 // most ships in a fleet, ship ids must fit in a short
+#define MAX_SHIP_LEN 10                               // longest ship
+
+// board size and fleet a game is played with
+// ship i of each player's fleet is lens[i] cells long
+typedef struct
+{
+    int width, height;
+    int nships;
+    unsigned char lens[MAX_SHIPS];
+} rules;
+
+extern const rules standardRules; // 10 x 10 board, ships of 5, 4, 3, 3 and 2
+
+/* Rules
+*********************************************************************/
+int checkRules(const rules *r);
+int parseRules(const char *text, rules *r);
+bool sparseRules(const rules *r);
+bool bitboardRules(const rules *r);
+bool displayRules(const rules *r);
+/********************************************************************/
+
+#endif
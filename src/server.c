@@ -0,0 +1,634 @@
+/*
+Battleship matchmaking server
+
+Hosts thousands of network games at once w/o rendering. Each core runs an event loop
+w/ its own epoll instance and its own listening socket on the same port, so the kernel
+spreads clients between loops and loops share nothing but their statistics.
+A loop pairs clients in the order they connect to it and referees their game w/ its
+engine, acting as host to both, see network.h. Games and connections live in pools,
+see pool.h, each loop allocates once at startup, so hosting a game allocates nothing.
+
+Every second reports games being played, clients waiting for an opponent, games
+finished and shots resolved per second, and p50 and p99 latency of resolving a shot,
+from reading it off the socket to sending its result to both players.
+
+Usage: battleship-server [port] [threads] [sessions] [seconds] [rules]
+sessions is the most games played at once, split between loops
+seconds is how long to serve before printing totals and exiting, 0 (default) serves until killed
+rules choose board size and fleet, see parseRules()
+clients are battleship-net join, battleship-bots, or battleship join
+*/
+
+#define _GNU_SOURCE // SO_REUSEPORT, server only runs on Linux w/ epoll
+
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "network.h"
+
+#define MAX_EVENTS 256          // events a loop handles per wake
+#define PUBLISH_INTERVAL 0.1    // seconds between a loop publishing its statistics
+#define LATENCY_FINE 1e-7       // seconds of latency each of first LATENCY_STEPS histogram buckets counts, up to 1 ms
+#define LATENCY_COARSE 1e-4     // seconds each of the next LATENCY_STEPS buckets counts, up to 1 s
+#define LATENCY_STEPS 10000
+#define LATENCY_BUCKETS (2 * LATENCY_STEPS) // shots slower than 1 s count in last bucket
+
+// client connected to a loop
+typedef struct client
+{
+    netSession n;            // buffers and protocol state, server is host
+    game *g;                 // game client plays, NULL while waiting for an opponent and once game is over
+    struct client *opponent; // NULL once opponent left, last client to leave a game that isn't over releases it
+    int side;                // player client is in game
+    bool writing;            // epoll also waits for socket to take rest of out buffer
+} client;
+
+// shots and games one loop served since its statistics were last collected
+typedef struct
+{
+    long sessions, waiting; // games being played and clients waiting, when published
+    long games, abandoned, shots, rejected;
+    long latency[LATENCY_BUCKETS]; // shots by time taken to resolve them
+} serverStats;
+
+// event loop of one core and the pools of its games and clients
+typedef struct
+{
+    pthread_t thread;
+    int epoll, listener, wake; // wake is an eventfd that stops loop
+    const rules *rules;
+    uint64_t seed;             // seed of next game, salts commitments to fleets
+
+    pool games, clients;       // every two clients have a game, see startLoop()
+    client *waiting;           // client waiting for an opponent, NULL if none
+
+    serverStats local, shared; // loop counts into local and adds it to shared every PUBLISH_INTERVAL
+    pthread_mutex_t lock;      // guards shared
+    double lastPublish;
+} eventLoop;
+
+/* Clients
+*********************************************************************/
+// send what client's socket takes, and wait for it to take the rest if it's full
+void flushClient(eventLoop *l, client *c)
+{
+    struct epoll_event e;
+
+    flushSession(&c->n);
+    if (c->n.sock < 0 || c->writing == (c->n.outLen > 0))
+        return;
+    c->writing = c->n.outLen > 0;
+    e.events = EPOLLIN | (c->writing ? EPOLLOUT : 0);
+    e.data.ptr = c;
+    epoll_ctl(l->epoll, EPOLL_CTL_MOD, c->n.sock, &e);
+}
+
+// disconnect client, telling it why unless error is NET_OK
+// opponent of a game that isn't over is told its opponent disconnected
+void closeClient(eventLoop *l, client *c, int error)
+{
+    unsigned char msg[2] = {'E', error};
+    client *opponent = c->opponent;
+
+    if (c->n.sock < 0)
+        return;
+    if (error != NET_OK)
+        send(c->n.sock, msg, sizeof(msg), MSG_NOSIGNAL);
+    close(c->n.sock); // also removes socket from epoll
+    c->n.sock = -1;
+    if (l->waiting == c)
+        l->waiting = NULL;
+
+    if (opponent != NULL)
+    {
+        c->opponent = NULL;
+        opponent->opponent = NULL;
+        if (opponent->n.state != NET_OVER)
+        {
+            l->local.abandoned++;
+            closeClient(l, opponent, NET_DISCONNECTED);
+        }
+    }
+    else if (c->g != NULL)
+        releaseGame(&l->games, c->g);
+    releaseSlot(&l->clients, c);
+}
+
+// tell client rules of its game and whether it shoots first
+void sendHello(client *c, const rules *r)
+{
+    putInt(&c->n, 'H', 1);
+    putBytes(&c->n, NET_MAGIC, 4);
+    putInt(&c->n, NET_VERSION, 1);
+    putInt(&c->n, r->width, 2);
+    putInt(&c->n, r->height, 2);
+    putInt(&c->n, r->nships, 2);
+    for (int i = 0; i < r->nships; i++)
+        putInt(&c->n, r->lens[i], 1);
+    putInt(&c->n, c->side == 0, 1); // players[0] shoots first
+    c->n.state = NET_PLACING;
+}
+
+// pair two clients into a new game, a plays players[0] and shoots first
+// returns 0 on success, 1 if every game is in use
+int startMatch(eventLoop *l, client *a, client *b)
+{
+    game *g = acquireGame(&l->games, l->rules);
+    client *players[2] = {a, b};
+
+    if (g == NULL)
+        return 1;
+    seedGame(g, l->seed++);
+    for (int i = 0; i < 2; i++)
+    {
+        players[i]->g = g;
+        players[i]->opponent = players[!i];
+        players[i]->side = i;
+        sendHello(players[i], l->rules);
+        flushClient(l, players[i]);
+    }
+    return 0;
+}
+
+// accept every waiting connection and match it w/ the client waiting before it
+void acceptClients(eventLoop *l)
+{
+    struct epoll_event e;
+    client *c;
+    int sock;
+
+    while ((sock = accept(l->listener, NULL, NULL)) >= 0)
+    {
+        c = acquireSlot(&l->clients);
+        if (c == NULL || setNonBlocking(sock))
+        {
+            if (c != NULL)
+                releaseSlot(&l->clients, c);
+            l->local.rejected++;
+            close(sock);
+            continue;
+        }
+        initializeSession(&c->n, true, false);
+        c->n.sock = sock;
+        c->g = NULL;
+        c->opponent = NULL;
+        c->writing = false;
+
+        e.events = EPOLLIN;
+        e.data.ptr = c;
+        epoll_ctl(l->epoll, EPOLL_CTL_ADD, sock, &e);
+        if (l->waiting == NULL)
+            l->waiting = c;
+        else if (startMatch(l, l->waiting, c))
+        {
+            // games are released once over, so this only happens if clients outnumber games
+            l->local.rejected++;
+            closeClient(l, c, NET_OK);
+        }
+        else
+            l->waiting = NULL;
+    }
+}
+/********************************************************************/
+
+/* Refereeing
+*********************************************************************/
+// histogram bucket counting a shot resolved in given seconds
+int latencyBucket(double seconds)
+{
+    long bucket = seconds / LATENCY_FINE;
+
+    if (bucket >= LATENCY_STEPS)
+        bucket = LATENCY_STEPS + (long)((seconds - LATENCY_STEPS * LATENCY_FINE) / LATENCY_COARSE);
+    return (bucket < LATENCY_BUCKETS) ? bucket : LATENCY_BUCKETS - 1;
+}
+
+// queue result of shooter's last shot to client, shooter is 1 if it's client's own shot
+void putShotResult(client *c, game *g, int shooter, int result)
+{
+    player *target = &g->players[!shooter];
+    int cell = g->players[shooter].lastShot;
+    ship *s;
+
+    putInt(&c->n, 'X', 1);
+    putInt(&c->n, shooter == c->side, 1);
+    putInt(&c->n, cell, 4);
+    putInt(&c->n, result, 1);
+    if (result == 3)
+    {
+        s = &target->ships[shipAtCell(target, cell)];
+        putInt(&c->n, s - target->ships, 2);
+        putInt(&c->n, s->cells[s->center], 4);
+        putInt(&c->n, s->rot, 1);
+    }
+}
+
+// place client's fleet, and start game once both fleets are placed
+// each client is sent a commitment to its opponent's fleet, revealed once game is over
+// returns NET_OK, or reason to close client
+int readClientFleet(eventLoop *l, client *c, const unsigned char *p)
+{
+    unsigned char fleet[NET_FLEET_BYTES * MAX_SHIPS];
+    game *g = c->g;
+    client *players[2];
+    int cell;
+
+    p++;
+    for (int i = 0; i < g->rules.nships; i++, p += NET_FLEET_BYTES)
+    {
+        cell = getCell(g, p);
+        if (cell < 0 || placeShip(g, c->side, i, cell % g->rules.width + 1, cell / g->rules.width + 1, p[4]))
+            return NET_PROTOCOL;
+    }
+    c->n.peerReady = true;
+
+    if (c->opponent == NULL)
+        return NET_OK;
+    players[c->side] = c;
+    players[!c->side] = c->opponent;
+    if (!players[0]->n.peerReady || !players[1]->n.peerReady || beginGame(g))
+        return NET_OK;
+
+    for (int i = 0; i < 2; i++)
+    {
+        fleetBytes(&g->players[!i], fleet);
+        players[i]->n.salt = rngNext(&g->guesses[i].rng);
+        putInt(&players[i]->n, 'R', 1);
+        putInt(&players[i]->n, hashFleet(players[i]->n.salt, fleet, NET_FLEET_BYTES * g->rules.nships), 8);
+        players[i]->n.state = NET_PLAYING;
+        flushClient(l, players[i]);
+    }
+    return NET_OK;
+}
+
+// resolve client's shot and send result to both players, and fleets they played against once game is over
+// received is when shot was read, for its latency
+// returns NET_OK, or reason to close client
+int readClientShot(eventLoop *l, client *c, const unsigned char *p, double received)
+{
+    unsigned char fleet[NET_FLEET_BYTES * MAX_SHIPS];
+    game *g = c->g;
+    client *players[2];
+    int cell = getCell(g, p + 1), result;
+
+    if (c->n.state != NET_PLAYING || g->turn % 2 != c->side || cell < 0)
+        return NET_PROTOCOL;
+    result = fireShot(g, cell % g->rules.width + 1, cell / g->rules.width + 1);
+    if (!result)
+        return NET_PROTOCOL;
+
+    // opponent has never left a game that's being played, see closeClient()
+    players[c->side] = c;
+    players[!c->side] = c->opponent;
+    for (int i = 0; i < 2; i++)
+    {
+        putShotResult(players[i], g, c->side, result);
+        if (!g->running)
+        {
+            fleetBytes(&g->players[!i], fleet);
+            putInt(&players[i]->n, 'V', 1);
+            putInt(&players[i]->n, players[i]->n.salt, 8);
+            putBytes(&players[i]->n, fleet, NET_FLEET_BYTES * g->rules.nships);
+            players[i]->n.state = NET_OVER;
+        }
+        flushClient(l, players[i]);
+    }
+
+    l->local.latency[latencyBucket(netTime() - received)]++;
+    l->local.shots++;
+    if (!g->running)
+    {
+        // clients may stay connected until they've read the end of game, but don't need it anymore
+        l->local.games++;
+        releaseGame(&l->games, g);
+        c->g = NULL;
+        c->opponent->g = NULL;
+    }
+    return NET_OK;
+}
+
+// handle one complete message from client
+// clients only ping until they're matched and once their game is over
+// returns NET_OK, or reason to close client
+int handleClientMessage(eventLoop *l, client *c, const unsigned char *p, double received)
+{
+    switch (p[0])
+    {
+    case 'F':
+        return (c->n.state == NET_PLACING && !c->n.peerReady) ? readClientFleet(l, c, p) : NET_PROTOCOL;
+    case 'S':
+        return readClientShot(l, c, p, received);
+    case 'P':
+        putInt(&c->n, 'Q', 1);
+        putBytes(&c->n, p + 1, 8);
+        return NET_OK;
+    case 'Q':
+        return NET_OK;
+    }
+    return NET_PROTOCOL;
+}
+
+// read and handle everything client sent
+void readClient(eventLoop *l, client *c)
+{
+    game *g;
+    long len, received;
+    size_t done = 0;
+    int error;
+    bool closed = false;
+    double now;
+
+    while (c->n.inLen < NET_BUFFER_SIZE)
+    {
+        received = recv(c->n.sock, c->n.in + c->n.inLen, NET_BUFFER_SIZE - c->n.inLen, 0);
+        if (received == 0 || (received < 0 && !wouldBlock()))
+            closed = true;
+        if (received <= 0)
+            break;
+        c->n.inLen += received;
+    }
+    now = netTime();
+
+    while (c->n.sock >= 0 && done < c->n.inLen)
+    {
+        g = c->g; // game is released by the shot that ends it
+        if (g == NULL && c->n.in[done] != 'P')
+        {
+            closeClient(l, c, NET_PROTOCOL);
+            return;
+        }
+        len = messageLength(g, c->n.in + done, c->n.inLen - done);
+        if (len < 0 || len > NET_BUFFER_SIZE)
+        {
+            closeClient(l, c, NET_PROTOCOL);
+            return;
+        }
+        if (len == 0 || done + len > c->n.inLen)
+            break;
+        error = handleClientMessage(l, c, c->n.in + done, now);
+        if (error != NET_OK)
+        {
+            closeClient(l, c, error);
+            return;
+        }
+        done += len;
+    }
+    memmove(c->n.in, c->n.in + done, c->n.inLen - done);
+    c->n.inLen -= done;
+
+    // clients close once they've read the end of their game
+    if (closed)
+        closeClient(l, c, NET_OK);
+    else
+        flushClient(l, c);
+}
+/********************************************************************/
+
+/* Event Loops
+*********************************************************************/
+// listen on port alongside other loops and allocate pools for capacity games
+// returns 0 on success, 1 if port can't be listened on or memory ran out
+int startLoop(eventLoop *l, int port, long capacity, const rules *r, uint64_t seed)
+{
+    struct sockaddr_in addr;
+    struct epoll_event e;
+    int one = 1;
+
+    memset(l, 0, sizeof(eventLoop));
+    l->rules = r;
+    l->seed = seed;
+    l->lastPublish = netTime();
+    pthread_mutex_init(&l->lock, NULL);
+
+    // serving games allocates nothing, every game and client is taken from these pools
+    // slots' pages are only touched once games and clients use them
+    if (initializeGamePool(&l->games, capacity, l->rules) || initializePool(&l->clients, sizeof(client), 2 * capacity))
+        return 1;
+
+    // every loop listens on the same port, kernel balances connections between them
+    l->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (l->listener < 0)
+        return 1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    setsockopt(l->listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(l->listener, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    if (bind(l->listener, (struct sockaddr *)&addr, sizeof(addr)) || listen(l->listener, SOMAXCONN) || setNonBlocking(l->listener))
+        return 1;
+
+    l->epoll = epoll_create1(0);
+    l->wake = eventfd(0, 0);
+    if (l->epoll < 0 || l->wake < 0)
+        return 1;
+    e.events = EPOLLIN;
+    e.data.ptr = &l->listener;
+    epoll_ctl(l->epoll, EPOLL_CTL_ADD, l->listener, &e);
+    e.data.ptr = &l->wake;
+    epoll_ctl(l->epoll, EPOLL_CTL_ADD, l->wake, &e);
+    return 0;
+}
+
+// add loop's statistics since last publish to those reports collect
+void publishStats(eventLoop *l)
+{
+    l->local.sessions = slotsInUse(&l->games);
+    l->local.waiting = l->waiting != NULL;
+
+    pthread_mutex_lock(&l->lock);
+    l->shared.sessions = l->local.sessions;
+    l->shared.waiting = l->local.waiting;
+    l->shared.games += l->local.games;
+    l->shared.abandoned += l->local.abandoned;
+    l->shared.shots += l->local.shots;
+    l->shared.rejected += l->local.rejected;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+        l->shared.latency[i] += l->local.latency[i];
+    pthread_mutex_unlock(&l->lock);
+
+    memset(&l->local, 0, sizeof(serverStats));
+    l->lastPublish = netTime();
+}
+
+// serve clients until loop is woken to stop
+void *runLoop(void *arg)
+{
+    eventLoop *l = arg;
+    struct epoll_event events[MAX_EVENTS];
+    client *c;
+    int n;
+    bool running = true;
+
+    while (running)
+    {
+        n = epoll_wait(l->epoll, events, MAX_EVENTS, PUBLISH_INTERVAL * 1000);
+        for (int i = 0; i < n; i++)
+        {
+            if (events[i].data.ptr == &l->listener)
+                acceptClients(l);
+            else if (events[i].data.ptr == &l->wake)
+                running = false;
+            else
+            {
+                // client may have been closed by its opponent earlier in this batch
+                c = events[i].data.ptr;
+                if (c->n.sock < 0)
+                    continue;
+                if (events[i].events & EPOLLOUT)
+                    flushClient(l, c);
+                if (c->n.sock >= 0 && events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+                    readClient(l, c);
+            }
+        }
+        if (netTime() - l->lastPublish >= PUBLISH_INTERVAL)
+            publishStats(l);
+    }
+    publishStats(l);
+    return NULL;
+}
+
+// close loop's sockets and free its pools, once its thread has stopped
+void stopLoop(eventLoop *l)
+{
+    client *c;
+
+    // clients released after being used are already closed
+    for (long i = 0; i < l->clients.touched; i++)
+    {
+        c = poolSlot(&l->clients, i);
+        if (c->n.sock >= 0)
+            close(c->n.sock);
+    }
+    close(l->listener);
+    close(l->epoll);
+    close(l->wake);
+    freeGamePool(&l->games);
+    freePool(&l->clients);
+    pthread_mutex_destroy(&l->lock);
+}
+
+// move statistics every loop published since last call into interval, and add them to total
+void collectStats(eventLoop *loops, long threads, serverStats *interval, serverStats *total)
+{
+    memset(interval, 0, sizeof(serverStats));
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_mutex_lock(&loops[i].lock);
+        interval->sessions += loops[i].shared.sessions;
+        interval->waiting += loops[i].shared.waiting;
+        interval->games += loops[i].shared.games;
+        interval->abandoned += loops[i].shared.abandoned;
+        interval->shots += loops[i].shared.shots;
+        interval->rejected += loops[i].shared.rejected;
+        for (int b = 0; b < LATENCY_BUCKETS; b++)
+            interval->latency[b] += loops[i].shared.latency[b];
+        memset(&loops[i].shared, 0, sizeof(serverStats));
+        pthread_mutex_unlock(&loops[i].lock);
+    }
+
+    total->games += interval->games;
+    total->abandoned += interval->abandoned;
+    total->shots += interval->shots;
+    total->rejected += interval->rejected;
+    for (int b = 0; b < LATENCY_BUCKETS; b++)
+        total->latency[b] += interval->latency[b];
+}
+/********************************************************************/
+
+// latency in microseconds that share q of shots in histogram resolved within, upper end of its bucket
+double percentile(const long *latency, long shots, double q)
+{
+    long count = 0;
+
+    if (shots == 0)
+        return 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+    {
+        count += latency[i];
+        if (count >= q * shots)
+            return 1e6 * ((i < LATENCY_STEPS) ? (i + 1) * LATENCY_FINE : LATENCY_STEPS * LATENCY_FINE + (i + 1 - LATENCY_STEPS) * LATENCY_COARSE);
+    }
+    return 1e6 * (LATENCY_STEPS * LATENCY_FINE + LATENCY_STEPS * LATENCY_COARSE);
+}
+
+int main(int argc, char *argv[])
+{
+    int port = (argc > 1) ? atoi(argv[1]) : NET_PORT;
+    long threads = (argc > 2) ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    long sessions = (argc > 3) ? atol(argv[3]) : 4096;
+    double seconds = (argc > 4) ? atof(argv[4]) : 0, start, elapsed, last;
+    rules r = standardRules;
+    eventLoop *loops;
+    serverStats *interval = calloc(1, sizeof(serverStats)), *total = calloc(1, sizeof(serverStats));
+    uint64_t stop = 1;
+    struct timespec pause = {1, 0};
+
+    if (port < 1 || threads < 1 || sessions < 1 || seconds < 0 || (argc > 5 && parseRules(argv[5], &r)))
+    {
+        printf("Usage: %s [port] [threads] [sessions] [seconds] [rules]\n", argv[0]);
+        printf("rules: WIDTHxHEIGHT[:LEN[*COUNT],...] up to 64x64, like 20x20\n");
+        return 1;
+    }
+    if (threads > sessions)
+        threads = sessions;
+    loops = calloc(threads, sizeof(eventLoop));
+    if (loops == NULL || interval == NULL || total == NULL)
+        return 1;
+
+    for (long i = 0; i < threads; i++)
+    {
+        if (startLoop(&loops[i], port, (sessions + threads - 1) / threads, &r, (uint64_t)time(NULL) ^ ((uint64_t)i << 32)))
+        {
+            printf("Can't listen on port %d\n", port);
+            return 1;
+        }
+    }
+    for (long i = 0; i < threads; i++)
+        pthread_create(&loops[i].thread, NULL, runLoop, &loops[i]);
+
+    printf("Serving %dx%d games on port %d, %ld loops, up to %ld games at once\n", r.width, r.height, port, threads, threads * loops[0].games.capacity);
+    printf("%8s %9s %8s %10s %11s %9s %9s\n", "seconds", "sessions", "waiting", "games/sec", "shots/sec", "p50 us", "p99 us");
+    start = last = netTime();
+    do
+    {
+        nanosleep(&pause, NULL);
+
+        collectStats(loops, threads, interval, total);
+        elapsed = netTime() - last;
+        last += elapsed;
+        printf("%8.0f %9ld %8ld %10.1f %11.0f %9.1f %9.1f\n", last - start, interval->sessions, interval->waiting, interval->games / elapsed,
+               interval->shots / elapsed, percentile(interval->latency, interval->shots, 0.5), percentile(interval->latency, interval->shots, 0.99));
+        fflush(stdout);
+    } while (seconds == 0 || last - start < seconds);
+
+    for (long i = 0; i < threads; i++)
+        write(loops[i].wake, &stop, sizeof(stop));
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(loops[i].thread, NULL);
+        stopLoop(&loops[i]);
+    }
+    collectStats(loops, threads, interval, total); // loops publish once more as they stop
+
+    elapsed = netTime() - start;
+    printf("\ngames      %ld, %ld abandoned\n", total->games, total->abandoned);
+    if (total->rejected)
+        printf("rejected   %ld clients, server full\n", total->rejected);
+    printf("shots      %ld\n", total->shots);
+    printf("shots/sec  %.0f\n", total->shots / elapsed);
+    printf("latency    p50 %.1f us, p99 %.1f us\n", percentile(total->latency, total->shots, 0.5), percentile(total->latency, total->shots, 0.99));
+
+    free(loops);
+    free(interval);
+    free(total);
+    return 0;
+}
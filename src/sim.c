@@ -0,0 +1,278 @@
+/*
+Battleship self-play simulator
+
+Plays computer vs computer games on every core w/o rendering.
+Each worker thread owns its game state and random state, and game i is always
+seeded from seed + i, so results don't depend on the number of threads.
+
+Usage: battleship-sim [games] [threads] [seed] [strategy0] [strategy1] [rules] [replay]
+strategy0 and strategy1 choose each player's shooting strategy:
+random, hunt (default), parity or density
+rules choose board size and fleet, see parseRules(), like 20x20 or 50x50:5*10,4*10,3*20,2*20
+replay is a file to record every game to, in game order, see replay.h
+*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "game.h"
+#include "replay.h"
+
+// games played by one worker thread and their results
+typedef struct
+{
+    pthread_t thread;
+    long first, count; // play games first to first + count - 1
+    uint64_t seed;
+    const strategy *strategies[2];
+    const rules *rules;
+    long wins[2], failed, stuck; // games won by each player, games whose fleets didn't fit and games a strategy had no shot in
+    long *shots[2];  // games won by each player, by number of shots taken by winner, one count per cell of board and 0
+    FILE *replay;    // temporary file of worker's recorded games, NULL if not recording
+    int failedWrite; // recording games failed
+    int noGame;      // worker's game couldn't be allocated, so it played none of its games
+} simWorker;
+
+// play one computer vs computer game, recorded to w unless it's NULL
+// returns winning player, -1 if a fleet didn't fit on board or memory ran out,
+// -2 if a strategy had no shot to take before game was over, which would otherwise loop forever
+int playGame(game *g, uint64_t seed, const strategy *strategies[2], const rules *r, replayWriter *w)
+{
+    if (initializeGame(g, r))
+        return -1;
+    seedGame(g, seed);
+    setStrategy(g, 0, strategies[0]);
+    setStrategy(g, 1, strategies[1]);
+    if (placeRandomFleet(g, 0) || placeRandomFleet(g, 1) || beginGame(g))
+        return -1;
+
+    if (w == NULL)
+    {
+        while (g->running)
+        {
+            if (!computerShot(g))
+                return -2;
+        }
+        return gameWinner(g);
+    }
+
+    // unfinished game is still ended, so later games in replay can be read
+    writeReplayHeader(w, g);
+    while (g->running && computerShot(g))
+        writeReplayShot(w, g);
+    writeReplayEnd(w);
+    return g->running ? -2 : gameWinner(g);
+}
+
+// play worker's range of games
+void *runWorker(void *arg)
+{
+    simWorker *w = arg;
+    game *g = createGame(w->rules);
+    replayWriter *replay = NULL;
+    int result;
+
+    if (g == NULL)
+    {
+        w->noGame = 1;
+        return NULL;
+    }
+    if (w->replay != NULL)
+    {
+        replay = malloc(sizeof(replayWriter));
+        if (replay == NULL)
+        {
+            w->failedWrite = 1;
+            destroyGame(g);
+            return NULL;
+        }
+        initializeReplayWriter(replay, w->replay);
+    }
+
+    for (long i = w->first; i < w->first + w->count; i++)
+    {
+        result = playGame(g, w->seed + i, w->strategies, w->rules, replay);
+        if (result == -2)
+        {
+            w->stuck++;
+            continue;
+        }
+        if (result < 0)
+        {
+            w->failed++;
+            continue;
+        }
+        w->wins[result]++;
+        w->shots[result][g->players[result].shotsTaken]++;
+    }
+    if (replay != NULL)
+    {
+        w->failedWrite = flushReplay(replay);
+        free(replay);
+    }
+    destroyGame(g);
+    return NULL;
+}
+
+// copy rest of file from to end of file to
+// returns 0 on success, 1 if a read or write failed
+int appendFile(FILE *to, FILE *from)
+{
+    char buf[65536];
+    size_t len;
+
+    while ((len = fread(buf, 1, sizeof(buf), from)) > 0)
+    {
+        if (fwrite(buf, 1, len, to) != len)
+            return 1;
+    }
+    return ferror(from);
+}
+
+// wall clock time in seconds
+double now(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[])
+{
+    long games = (argc > 1) ? atol(argv[1]) : 100000;
+    long threads = (argc > 2) ? atol(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 0) : 1;
+    const strategy *strategies[2] = {(argc > 4) ? findStrategy(argv[4]) : &huntStrategy, (argc > 5) ? findStrategy(argv[5]) : &huntStrategy};
+    long *shots[2], wins[2] = {0, 0}, failed = 0, stuck = 0, noGame = 0, bucket[2], total[2] = {0, 0};
+    int cells, range, failedWrite = 0;
+    rules r = standardRules;
+    simWorker *workers;
+    FILE *replay = NULL;
+    double start, seconds;
+
+    if (games < 1 || threads < 1 || strategies[0] == NULL || strategies[1] == NULL || (argc > 6 && parseRules(argv[6], &r)))
+    {
+        printf("Usage: %s [games] [threads] [seed] [strategy0] [strategy1] [rules] [replay]\n", argv[0]);
+        printf("strategies: random, hunt, parity, density\n");
+        printf("rules: WIDTHxHEIGHT[:LEN[*COUNT],...], like 20x20 or 50x50:5*10,4*10,3*20,2*20\n");
+        printf("replay: file to record games to\n");
+        return 1;
+    }
+    if (argc > 7 && (replay = fopen(argv[7], "wb")) == NULL)
+    {
+        printf("Can't open %s\n", argv[7]);
+        return 1;
+    }
+    cells = r.width * r.height;
+    if (threads > games)
+        threads = games;
+
+    // shot counts for every possible number of shots, boards up to 1000 x 1000 are too big for fixed arrays
+    workers = calloc(threads, sizeof(simWorker));
+    shots[0] = calloc(cells + 1, sizeof(long));
+    shots[1] = calloc(cells + 1, sizeof(long));
+    if (workers == NULL || shots[0] == NULL || shots[1] == NULL)
+        return 1;
+    for (long i = 0; i < threads; i++)
+    {
+        workers[i].shots[0] = calloc(cells + 1, sizeof(long));
+        workers[i].shots[1] = calloc(cells + 1, sizeof(long));
+        if (workers[i].shots[0] == NULL || workers[i].shots[1] == NULL)
+            return 1;
+
+        // each worker records to its own file, joined in game order once every worker is done
+        if (replay != NULL && (workers[i].replay = tmpfile()) == NULL)
+            return 1;
+    }
+
+    // split games evenly between workers
+    start = now();
+    for (long i = 0; i < threads; i++)
+    {
+        workers[i].first = games * i / threads;
+        workers[i].count = games * (i + 1) / threads - workers[i].first;
+        workers[i].seed = seed;
+        workers[i].strategies[0] = strategies[0];
+        workers[i].strategies[1] = strategies[1];
+        workers[i].rules = &r;
+        pthread_create(&workers[i].thread, NULL, runWorker, &workers[i]);
+    }
+
+    // combine results of each worker
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        failed += workers[i].failed;
+        stuck += workers[i].stuck;
+        noGame += workers[i].noGame;
+        if (replay != NULL)
+        {
+            rewind(workers[i].replay);
+            failedWrite |= workers[i].failedWrite || appendFile(replay, workers[i].replay);
+            fclose(workers[i].replay);
+        }
+        for (int p = 0; p < 2; p++)
+        {
+            wins[p] += workers[i].wins[p];
+            for (int n = 0; n <= cells; n++)
+                shots[p][n] += workers[i].shots[p][n];
+            free(workers[i].shots[p]);
+        }
+    }
+    seconds = now() - start;
+    free(workers);
+    if (replay != NULL && fclose(replay))
+        failedWrite = 1;
+
+    // results would leave out every game of a worker that couldn't play
+    if (noGame)
+    {
+        printf("Can't allocate games of %ld of %ld threads\n", noGame, threads);
+        return 1;
+    }
+
+    printf("games      %ld\n", games);
+    printf("threads    %ld\n", threads);
+    printf("seed       %llu\n", (unsigned long long)seed);
+    printf("board      %dx%d, %d ships\n", r.width, r.height, r.nships);
+    printf("seconds    %.3f\n", seconds);
+    printf("games/sec  %.1f\n", games / seconds);
+    if (failed)
+        printf("failed     %ld games, fleet didn't fit\n", failed);
+    if (stuck)
+        printf("stuck      %ld games, strategy had no shot to take\n", stuck);
+    if (replay != NULL)
+        printf("replay     %s%s\n", argv[7], failedWrite ? ", writing failed" : "");
+    printf("\n");
+
+    for (int p = 0; p < 2; p++)
+    {
+        for (int n = 0; n <= cells; n++)
+            total[p] += shots[p][n] * n;
+        printf("player %d   %-8s %6.2f%% wins (%ld), %.2f shots per win\n", p, strategies[p]->name, 100.0 * wins[p] / games, wins[p], wins[p] ? (double)total[p] / wins[p] : 0);
+    }
+
+    // share of all games won in each range of shots, a tenth of board per range on larger boards
+    range = (cells > 100) ? cells / 10 : 10;
+    printf("\nshots      player 0  player 1\n");
+    for (int n = 0; n <= cells; n += range)
+    {
+        for (int p = 0; p < 2; p++)
+        {
+            bucket[p] = 0;
+            for (int i = n; i < n + range && i <= cells; i++)
+                bucket[p] += shots[p][i];
+        }
+        if (bucket[0] || bucket[1])
+            printf("%3d-%-3d   %7.2f%%  %7.2f%%\n", n, (n + range - 1 < cells) ? n + range - 1 : cells, 100.0 * bucket[0] / games, 100.0 * bucket[1] / games);
+    }
+    free(shots[0]);
+    free(shots[1]);
+
+    return failedWrite || stuck;
+}
@@ -0,0 +1,746 @@
+#include <stddef.h>
+#include <string.h>
+#include "strategy.h"
+
+// bit-sliced counter planes, enough for the largest possible count of a cell w/ any fleet on a 10 x 10 board
+#define DENSITY_PLANES 16
+
+#define RANDOM_TRIES 16 // random cells tried before picking from every open cell on boards w/o bitboards
+
+/* Shared Helpers
+*********************************************************************/
+// check that cell is on board and not shot by p2 yet
+bool openCell(player *p2, int x, int y)
+{
+    if (x > p2->width || x < 1 || y > p2->height || y < 1)
+        return false;
+    return !shotAt(p2, cellIndex(p2, x, y));
+}
+
+// pick a random cell from mask, mask must not be empty
+void randomCell(opponentGuess *opGuess, bitboard cells, int *x, int *y)
+{
+    int cell = bbNth(cells, rngBounded(&opGuess->rng, bbCount(cells)));
+
+    *x = cell % BOARD_SIZE + 1;
+    *y = cell / BOARD_SIZE + 1;
+}
+
+// pick a random cell not shot by p2 yet where (x + y) is a multiple of spacing, on a board of any size
+// returns false if there is none, or on sparse boards if none turned up
+bool randomOpenCell(player *p2, opponentGuess *opGuess, int spacing, int *x, int *y)
+{
+    int count = 0, n;
+
+    // random cells are usually open until late in game, so try a few before counting them all
+    // sparse boards are too big to count, so any open cell is drawn until one turns up
+    for (int i = 0; (p2->sparse && spacing == 1) ? p2->shotsTaken < p2->width * p2->height : i < RANDOM_TRIES; i++)
+    {
+        *x = rngBounded(&opGuess->rng, p2->width) + 1;
+        *y = rngBounded(&opGuess->rng, p2->height) + 1;
+        if ((*x + *y) % spacing == 0 && openCell(p2, *x, *y))
+            return true;
+    }
+    if (p2->sparse)
+        return false;
+
+    for (int cellY = 1; cellY <= p2->height; cellY++)
+    {
+        for (int cellX = 1; cellX <= p2->width; cellX++)
+            count += (cellX + cellY) % spacing == 0 && openCell(p2, cellX, cellY);
+    }
+    if (count == 0)
+        return false;
+
+    n = rngBounded(&opGuess->rng, count);
+    for (int cellY = 1; cellY <= p2->height; cellY++)
+    {
+        for (int cellX = 1; cellX <= p2->width; cellX++)
+        {
+            if ((cellX + cellY) % spacing == 0 && openCell(p2, cellX, cellY) && n-- == 0)
+            {
+                *x = cellX;
+                *y = cellY;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// reset everything any built-in strategy keeps
+void resetGuess(opponentGuess *opGuess)
+{
+    resetOpGuess(opGuess);
+    resetPlacements(opGuess);
+    opGuess->nopenHits = 0;
+}
+
+// for strategies that don't learn from results
+void ignoreResult(player *p1, player *p2, opponentGuess *opGuess, int x, int y, int result)
+{
+}
+/********************************************************************/
+
+/* Random
+*********************************************************************/
+void randomChoose(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    if (!p2->bitboards)
+    {
+        randomOpenCell(p2, opGuess, 1, x, y);
+        return;
+    }
+    randomCell(opGuess, bbAndNot(bbFull(), bbOr(p2->hits, p2->misses)), x, y);
+}
+/********************************************************************/
+
+/* Hunt
+    select random cell
+    hit or miss
+    if hit
+        random cell in 1 of 4 possible directions
+        if hit, gusss in cells either direction along line
+        if miss, select new direction
+    if miss
+        new random cell
+    keep track of last hit until ship has sank, then reset
+*********************************************************************/
+// turn away from a miss or a cell that can't be shot
+void huntMissed(opponentGuess *opGuess, int rot)
+{
+    // incremenet if shot following initial is a miss
+    if (opGuess->offset1 == 0)
+    {
+        opGuess->rot = (opGuess->rot + 1) % 4;
+
+        // guess in opposite direction if shots in each direction have already been taken and/or are misses
+        if (opGuess->rot == rot)
+            opGuess->offset2 = 1;
+    }
+
+    else
+        opGuess->offset2 = 1; // guess in opposite direction
+}
+
+// next cell along line from last hit, returns false if there are no open cells to try
+bool huntTarget(player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    int gridX, gridY, rot, offset;
+
+    for (int i = 0; i < 4; i++)
+    {
+        // get initial hit
+        gridX = opGuess->initX;
+        gridY = opGuess->initY;
+
+        // determine direction (left/right or up/down) of shot
+        // offset1- initial direction, offset2- opposite direction of offset1
+        offset = (opGuess->offset2 > 0) ? opGuess->offset2 * -1 : opGuess->offset1 + 1;
+
+        // determine ship's rotation and add offset to get shot position
+        if (opGuess->rot == -1)
+            opGuess->rot = rngBounded(&opGuess->rng, 4); // assign random rotation if unknown
+        rot = opGuess->rot;
+        switch (opGuess->rot)
+        {
+        case 0:
+            gridX = opGuess->initX - offset;
+            break;
+        case 1:
+            gridY = opGuess->initY - offset;
+            break;
+        case 2:
+            gridX = opGuess->initX + offset;
+            break;
+        case 3:
+            gridY = opGuess->initY + offset;
+            break;
+        }
+
+        if (openCell(p2, gridX, gridY))
+        {
+            *x = gridX;
+            *y = gridY;
+            return true;
+        }
+        huntMissed(opGuess, rot);
+    }
+    return false;
+}
+
+void huntChoose(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    int pos[2];
+
+    // check if computer player previously had a hit
+    if (opGuess->initX != 0 && opGuess->initY != 0)
+    {
+        if (huntTarget(p2, opGuess, x, y))
+            return;
+
+        // take random guess if more than four consecutive computer player's shot have already been taken
+        resetOpGuess(opGuess);
+    }
+
+    // take random shot if computer player did not have previous hit
+    do
+    {
+        if (p2->width == p2->height)
+            rngFillBounded(&opGuess->rng, pos, 2, p2->width);
+        else
+        {
+            pos[0] = rngBounded(&opGuess->rng, p2->width);
+            pos[1] = rngBounded(&opGuess->rng, p2->height);
+        }
+        *x = pos[0] + 1;
+        *y = pos[1] + 1;
+    } while (!openCell(p2, *x, *y));
+}
+
+void huntObserve(player *p1, player *p2, opponentGuess *opGuess, int x, int y, int result)
+{
+    // keep track of position if random shot is a hit
+    if (opGuess->initX == 0 || opGuess->initY == 0)
+    {
+        if (result == 2)
+        {
+            opGuess->initX = x;
+            opGuess->initY = y;
+        }
+        return;
+    }
+
+    switch (result)
+    {
+    case 2:
+
+        // continue guessing in current direction if shot is a hit
+        if (opGuess->offset2 > 0)
+            opGuess->offset2 += 1;
+        else
+            opGuess->offset1 += 1;
+
+        break;
+    case 3:
+
+        // next shot is random if ship is sunk
+        resetOpGuess(opGuess);
+
+        break;
+    default:
+        huntMissed(opGuess, opGuess->rot);
+        break;
+    }
+}
+/********************************************************************/
+
+/* Parity
+    hunt, but random shots only go to cells where (x + y) is a multiple of
+    the shortest ship afloat, since every ship must cover one of them
+*********************************************************************/
+void parityChoose(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    bitboard open, lattice = bbEmpty();
+    int spacing = MAX_SHIP_LEN;
+
+    // search around last hit like hunt
+    if (opGuess->initX != 0 && opGuess->initY != 0)
+    {
+        if (huntTarget(p2, opGuess, x, y))
+            return;
+        resetOpGuess(opGuess);
+    }
+
+    for (int i = 0; i < p1->nships; i++)
+    {
+        if (!p1->ships[i].sunk && p1->ships[i].len < spacing)
+            spacing = p1->ships[i].len;
+    }
+
+    // any open cell once lattice is used up
+    if (!p2->bitboards)
+    {
+        if (!randomOpenCell(p2, opGuess, spacing, x, y))
+            randomOpenCell(p2, opGuess, 1, x, y);
+        return;
+    }
+
+    open = bbAndNot(bbFull(), bbOr(p2->hits, p2->misses));
+    for (int cellY = 1; cellY <= BOARD_SIZE; cellY++)
+    {
+        for (int cellX = 1; cellX <= BOARD_SIZE; cellX++)
+        {
+            if ((cellX + cellY) % spacing == 0)
+                bbSet(&lattice, bbIndex(cellX, cellY));
+        }
+    }
+
+    // any open cell once lattice is used up
+    lattice = bbAnd(lattice, open);
+    randomCell(opGuess, bbIsEmpty(lattice) ? open : lattice, x, y);
+}
+/********************************************************************/
+
+/* Density
+    count placements of each remaining ship that fit around misses and sunk ships
+    while hits on ships not yet sunk are known, only count placements through them
+    on sparse boards those hits are tracked from shooter's own results, see densityObserve()
+    shoot cell covered by most placements
+    placements ruled out by a miss or sunk ship are dropped for rest of game
+    sunk ships are revealed to the shooter, as in the standard rules
+*********************************************************************/
+// add weight to count of every cell in mask, counts must fit in nplanes bits
+// counts are bit-sliced: planes[k] holds bit k of each cell's count, so 128 cells are added at once
+void addDensity(bitboard planes[DENSITY_PLANES], int nplanes, bitboard mask, int weight)
+{
+    bitboard carry, next;
+
+    for (int j = 0; j < nplanes && weight >> j; j++)
+    {
+        if (!((weight >> j) & 1))
+            continue;
+
+        // ripple carry up from plane j
+        carry = mask;
+        for (int k = j; k < nplanes && !bbIsEmpty(carry); k++)
+        {
+            next = bbAnd(planes[k], carry);
+            planes[k] = bbXor(planes[k], carry);
+            carry = next;
+        }
+    }
+}
+
+// narrow candidates to cells w/ highest count
+bitboard maxDensity(bitboard planes[DENSITY_PLANES], int nplanes, bitboard candidates)
+{
+    bitboard top;
+
+    for (int k = nplanes - 1; k >= 0; k--)
+    {
+        top = bbAnd(candidates, planes[k]);
+        if (!bbIsEmpty(top))
+            candidates = top;
+    }
+    return candidates;
+}
+
+// density on a board kept in per-cell arrays, w/ a plain count for each cell
+// placements are counted a row or column at a time w/ a sliding window, so each length costs one pass over board
+void densityChooseCells(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    unsigned char known[MAX_CELLS]; // 0 for cells not shot, 1 for hits on ships not sunk, 2 for misses and sunk ships
+    int counts[MAX_CELLS], diff[MAX_BOARD_SIZE + 1], remaining[MAX_SHIP_LEN + 1] = {0}, cells = p2->width * p2->height;
+    int cell, first, step, lines, length, blocked, hits, weight, sum, best = -1, ties = 0, n;
+    bool open = false, counted = false;
+
+    for (cell = 0; cell < cells; cell++)
+        known[cell] = (p2->shots[cell] == SHOT_MISS) ? 2 : p2->shots[cell] == SHOT_HIT;
+    for (int i = 0; i < p1->nships; i++)
+    {
+        if (!p1->ships[i].sunk)
+        {
+            remaining[p1->ships[i].len]++;
+            continue;
+        }
+        for (int j = 0; j < p1->ships[i].len; j++)
+            known[p1->ships[i].cells[j]] = 2;
+    }
+    for (cell = 0; cell < cells; cell++)
+        open |= known[cell] == 1;
+
+    // target hits on ships not yet sunk, hunt whole board if none fit
+    for (int target = open; target >= 0 && !counted; target--)
+    {
+        for (cell = 0; cell < cells; cell++)
+            counts[cell] = 0;
+
+        for (int len = 1; len <= MAX_SHIP_LEN; len++)
+        {
+            if (!remaining[len])
+                continue;
+
+            // rows then columns
+            for (int vertical = 0; vertical < 2; vertical++)
+            {
+                lines = vertical ? p2->width : p2->height;
+                length = vertical ? p2->height : p2->width;
+                step = vertical ? p2->width : 1;
+                for (int line = 0; line < lines; line++)
+                {
+                    first = vertical ? line : line * p2->width;
+                    blocked = 0;
+                    hits = 0;
+                    for (int k = 0; k <= length; k++)
+                        diff[k] = 0;
+
+                    // window of len cells ending at k is a placement if nothing in it is blocked
+                    for (int k = 0; k < length; k++)
+                    {
+                        cell = first + k * step;
+                        blocked += known[cell] == 2;
+                        hits += known[cell] == 1;
+                        if (k >= len)
+                        {
+                            blocked -= known[cell - len * step] == 2;
+                            hits -= known[cell - len * step] == 1;
+                        }
+                        if (k < len - 1 || blocked)
+                            continue;
+
+                        // weight placements through more open hits higher when targeting
+                        weight = remaining[len] * (target ? hits : 1);
+                        diff[k - len + 1] += weight;
+                        diff[k + 1] -= weight;
+                    }
+
+                    sum = 0;
+                    for (int k = 0; k < length; k++)
+                    {
+                        sum += diff[k];
+                        counts[first + k * step] += sum;
+                    }
+                }
+            }
+        }
+
+        for (cell = 0; cell < cells; cell++)
+            counted |= !known[cell] && counts[cell] > 0;
+    }
+
+    // pick randomly between open cells w/ highest count
+    for (cell = 0; cell < cells; cell++)
+    {
+        if (p2->shots[cell])
+            continue;
+        if (counts[cell] > best)
+        {
+            best = counts[cell];
+            ties = 0;
+        }
+        ties += counts[cell] == best;
+    }
+
+    // no open cells left, game is over
+    *x = 0;
+    *y = 0;
+    if (ties == 0)
+        return;
+
+    n = rngBounded(&opGuess->rng, ties);
+    for (cell = 0; cell < cells; cell++)
+    {
+        if (!p2->shots[cell] && counts[cell] == best && n-- == 0)
+        {
+            *x = cell % p2->width + 1;
+            *y = cell / p2->width + 1;
+            return;
+        }
+    }
+}
+
+// whether cell is one of shooter's hits on a ship not sunk yet, see densityObserve()
+bool openHit(opponentGuess *opGuess, int cell)
+{
+    for (int i = 0; i < opGuess->nopenHits; i++)
+    {
+        if (opGuess->openHits[i] == cell)
+            return true;
+    }
+    return false;
+}
+
+// density on a sparse board, only counting placements through a hit on a ship not yet sunk
+// an ocean is mostly empty, so counts away from hits would be close to even anyway
+// open hits come from shooter's own results, so nothing hidden on p1's board is read
+void densityChooseSparse(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    int counts[2][2 * MAX_SHIP_LEN - 1]; // cells along row and column through hit, hit in the middle
+    int remaining[MAX_SHIP_LEN + 1] = {0}, hit, cell, shot, hits, weight, best = 0, ties = 0, n;
+    int hitX = 0, hitY = 0, cellX, cellY;
+    bool fits;
+
+    // lengths of ships still afloat
+    for (int i = 0; i < p1->nships; i++)
+    {
+        if (!p1->ships[i].sunk)
+            remaining[p1->ships[i].len]++;
+    }
+
+    // count placements around oldest open hit, or next one if nothing fits around it
+    for (int h = 0; h < opGuess->nopenHits && best == 0; h++)
+    {
+        hit = opGuess->openHits[h];
+        hitX = hit % p2->width + 1;
+        hitY = hit / p2->width + 1;
+
+        for (int vertical = 0; vertical < 2; vertical++)
+        {
+            for (int k = 0; k < 2 * MAX_SHIP_LEN - 1; k++)
+                counts[vertical][k] = 0;
+        }
+
+        for (int len = 1; len <= MAX_SHIP_LEN; len++)
+        {
+            if (!remaining[len])
+                continue;
+
+            // placements of len cells from start to start + len - 1 along row or column, through hit at 0
+            for (int vertical = 0; vertical < 2; vertical++)
+            {
+                for (int start = 1 - len; start <= 0; start++)
+                {
+                    fits = true;
+                    hits = 0;
+                    for (int k = start; k < start + len && fits; k++)
+                    {
+                        cellX = hitX + (vertical ? 0 : k);
+                        cellY = hitY + (vertical ? k : 0);
+                        if (cellX > p2->width || cellX < 1 || cellY > p2->height || cellY < 1)
+                        {
+                            fits = false;
+                            break;
+                        }
+
+                        // misses and hits on sunk ships are blocked
+                        cell = cellIndex(p2, cellX, cellY);
+                        shot = shotAt(p2, cell);
+                        fits = shot != SHOT_MISS && (shot != SHOT_HIT || openHit(opGuess, cell));
+                        hits += shot == SHOT_HIT;
+                    }
+                    if (!fits)
+                        continue;
+
+                    // weight placements through more open hits higher
+                    weight = remaining[len] * hits;
+                    for (int k = start; k < start + len; k++)
+                    {
+                        if (openCell(p2, hitX + (vertical ? 0 : k), hitY + (vertical ? k : 0)))
+                            counts[vertical][k + MAX_SHIP_LEN - 1] += weight;
+                    }
+                }
+            }
+        }
+
+        // hunt around next hit if nothing fits around this one
+        for (int vertical = 0; vertical < 2; vertical++)
+        {
+            for (int k = 0; k < 2 * MAX_SHIP_LEN - 1; k++)
+            {
+                if (counts[vertical][k] > best)
+                    best = counts[vertical][k];
+            }
+        }
+    }
+
+    // hunt whole board if nothing fits around any hit
+    if (best == 0)
+    {
+        randomOpenCell(p2, opGuess, 1, x, y);
+        return;
+    }
+
+    // pick randomly between open cells w/ highest count
+    for (int vertical = 0; vertical < 2; vertical++)
+    {
+        for (int k = 0; k < 2 * MAX_SHIP_LEN - 1; k++)
+            ties += counts[vertical][k] == best;
+    }
+    n = rngBounded(&opGuess->rng, ties);
+    for (int vertical = 0; vertical < 2; vertical++)
+    {
+        for (int k = 0; k < 2 * MAX_SHIP_LEN - 1; k++)
+        {
+            if (counts[vertical][k] == best && n-- == 0)
+            {
+                *x = hitX + (vertical ? 0 : k - MAX_SHIP_LEN + 1);
+                *y = hitY + (vertical ? k - MAX_SHIP_LEN + 1 : 0);
+                return;
+            }
+        }
+    }
+}
+
+// keep open hits for sparse boards, other boards find them from shooter's hit layer or shot array
+// a ship is revealed once it sinks, so hits on it are no longer open
+void densityObserve(player *p1, player *p2, opponentGuess *opGuess, int x, int y, int result)
+{
+    int cell, n = 0;
+    bool onShip;
+    ship *s;
+
+    if (!p2->sparse || result < 2)
+        return;
+
+    cell = cellIndex(p1, x, y);
+    if (result == 2)
+    {
+        if (opGuess->nopenHits < MAX_OPEN_HITS)
+            opGuess->openHits[opGuess->nopenHits++] = cell;
+        return;
+    }
+
+    // drop hits on ship that sank
+    s = &p1->ships[shipAtCell(p1, cell)];
+    for (int i = 0; i < opGuess->nopenHits; i++)
+    {
+        onShip = false;
+        for (int j = 0; j < s->len; j++)
+            onShip |= s->cells[j] == opGuess->openHits[i];
+        if (!onShip)
+            opGuess->openHits[n++] = opGuess->openHits[i];
+    }
+    opGuess->nopenHits = n;
+}
+
+void densityChoose(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y)
+{
+    bitboard planes[DENSITY_PLANES], sunkCells = bbEmpty(), shot, blocked, open, mask, candidates;
+    int remaining[MAX_SHIP_LEN + 1] = {0}, weight, placement, most = 0, nplanes = 0;
+    uint64_t bits;
+    bool counted = false;
+
+    if (p2->sparse)
+    {
+        densityChooseSparse(p1, p2, opGuess, x, y);
+        return;
+    }
+    if (!p2->bitboards)
+    {
+        densityChooseCells(p1, p2, opGuess, x, y);
+        return;
+    }
+
+    // lengths of ships still afloat and cells of sunk ships
+    for (int i = 0; i < p1->nships; i++)
+    {
+        if (p1->ships[i].sunk)
+            sunkCells = bbOr(sunkCells, p1->ships[i].mask);
+        else
+            remaining[p1->ships[i].len]++;
+    }
+
+    // planes needed for highest possible count, a cell is covered by at most 2 * len placements of a length
+    for (int len = 1; len <= MAX_SHIP_LEN; len++)
+        most += 2 * len * remaining[len] * len;
+    while (most >> nplanes)
+        nplanes++;
+
+    shot = bbOr(p2->hits, p2->misses);
+    blocked = bbOr(p2->misses, sunkCells);
+    open = bbAndNot(p2->hits, sunkCells);
+    candidates = bbAndNot(bbFull(), shot);
+
+    // no open cells left, game is over
+    if (bbIsEmpty(candidates))
+    {
+        *x = 0;
+        *y = 0;
+        return;
+    }
+
+    // target hits on ships not yet sunk, hunt whole board if none fit
+    for (int target = !bbIsEmpty(open); target >= 0 && !counted; target--)
+    {
+        for (int k = 0; k < nplanes; k++)
+            planes[k] = bbEmpty();
+
+        for (int len = 1; len <= MAX_SHIP_LEN; len++)
+        {
+            if (!remaining[len])
+                continue;
+
+            for (int i = 0; i < PLACEMENT_WORDS; i++)
+            {
+                bits = opGuess->placements[len][i];
+                while (bits)
+                {
+                    placement = i * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    if (placement >= placementCount(len))
+                        break;
+
+                    // rule out placements across misses or sunk ships for good
+                    mask = placementMask(len, placement);
+                    if (bbIntersects(mask, blocked))
+                    {
+                        opGuess->placements[len][i] &= ~((uint64_t)1 << (placement & 63));
+                        continue;
+                    }
+
+                    // weight placements through more open hits higher when targeting
+                    weight = remaining[len];
+                    if (target)
+                    {
+                        weight *= bbCount(bbAnd(mask, open));
+                        if (!weight)
+                            continue;
+                    }
+
+                    mask = bbAnd(mask, candidates);
+                    if (!bbIsEmpty(mask))
+                    {
+                        addDensity(planes, nplanes, mask, weight);
+                        counted = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // pick randomly between cells w/ highest count
+    if (counted)
+        candidates = maxDensity(planes, nplanes, candidates);
+    randomCell(opGuess, candidates, x, y);
+}
+/********************************************************************/
+
+/* Strategies
+*********************************************************************/
+const strategy randomStrategy = {"random", resetGuess, randomChoose, ignoreResult};
+const strategy huntStrategy = {"hunt", resetGuess, huntChoose, huntObserve};
+const strategy parityStrategy = {"parity", resetGuess, parityChoose, huntObserve};
+const strategy densityStrategy = {"density", resetGuess, densityChoose, densityObserve};
+
+const strategy *strategies[] = {&randomStrategy, &huntStrategy, &parityStrategy, &densityStrategy};
+
+// built-in shots w/ strategy functions inlined
+SPECIALIZE_STRATEGY(randomShot, randomChoose, ignoreResult)
+SPECIALIZE_STRATEGY(huntShot, huntChoose, huntObserve)
+SPECIALIZE_STRATEGY(parityShot, parityChoose, huntObserve)
+SPECIALIZE_STRATEGY(densityShot, densityChoose, densityObserve)
+
+// built-in strategy w/ given name, NULL if there is none
+const strategy *findStrategy(const char *name)
+{
+    for (int i = 0; i < sizeof(strategies) / sizeof(strategies[0]); i++)
+    {
+        if (strcmp(strategies[i]->name, name) == 0)
+            return strategies[i];
+    }
+    return NULL;
+}
+
+// p2 takes one shot at p1 using strategy
+// returns result of shot, see fireAt()
+int strategyShot(const strategy *st, player *p1, player *p2, bool *running, opponentGuess *opGuess)
+{
+    int x, y, result;
+
+    // built-in strategies skip calls through function pointers
+    if (st == &densityStrategy)
+        return densityShot(p1, p2, running, opGuess);
+    if (st == &huntStrategy)
+        return huntShot(p1, p2, running, opGuess);
+    if (st == &parityStrategy)
+        return parityShot(p1, p2, running, opGuess);
+    if (st == &randomStrategy)
+        return randomShot(p1, p2, running, opGuess);
+
+    st->chooseShot(p1, p2, opGuess, &x, &y);
+    result = fireAt(p2, p1, running, x, y);
+    st->observe(p1, p2, opGuess, x, y, result);
+    return result;
+}
+/********************************************************************/
@@ -0,0 +1,43 @@
+#ifndef __STRATEGY_H__
+#define __STRATEGY_H__
+
+#include <stdbool.h>
+#include "engine.h"
+#include "opponent.h"
+
+// computer player shooting strategy
+// p2 shoots at p1, x and y are cells on p1's board from 1 - width and 1 - height
+typedef struct
+{
+    const char *name;
+    void (*init)(opponentGuess *opGuess);                                                       // reset state at start of game
+    void (*chooseShot)(player *p1, player *p2, opponentGuess *opGuess, int *x, int *y);        // pick a cell not shot yet
+    void (*observe)(player *p1, player *p2, opponentGuess *opGuess, int x, int y, int result); // learn result of shot, see fireAt()
+} strategy;
+
+// define int name(player *p1, player *p2, bool *running, opponentGuess *opGuess)
+// that takes one shot calling choose and observe directly instead of through a strategy,
+// so hot strategies can be inlined into tight simulation loops
+#define SPECIALIZE_STRATEGY(name, choose, observe)                                \
+    static inline int name(player *p1, player *p2, bool *running, opponentGuess *opGuess) \
+    {                                                                             \
+        int x, y, result;                                                         \
+                                                                                  \
+        choose(p1, p2, opGuess, &x, &y);                                          \
+        result = fireAt(p2, p1, running, x, y);                                   \
+        observe(p1, p2, opGuess, x, y, result);                                   \
+        return result;                                                            \
+    }
+
+/* Built-in Strategies
+*********************************************************************/
+extern const strategy randomStrategy;  // random cell not shot yet
+extern const strategy huntStrategy;    // random shots, then search around last hit
+extern const strategy parityStrategy;  // hunt, but only shoot cells spaced by shortest ship afloat until a hit
+extern const strategy densityStrategy; // shoot cell covered by most possible ship placements
+/********************************************************************/
+
+const strategy *findStrategy(const char *name);
+int strategyShot(const strategy *st, player *p1, player *p2, bool *running, opponentGuess *opGuess);
+
+#endif
@@ -0,0 +1,256 @@
+/*
+Battleship search API tests
+
+Checks that games copied w/ copyGame(), saved and restored w/ snapshotGame()
+and restoreGame(), and played w/ makeShot() and taken back w/ unmakeShot()
+end up in the same state as games played w/ fireShot() and computerShot().
+Every check runs on the standard board and on boards w/o bitboards.
+
+Prints each failed check and a summary, exits 1 if any check failed.
+
+Usage: battleship-test
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "game.h"
+
+#define SNAPSHOT_SHOTS 30 // shots played before snapshot is taken
+
+#define CHECK(cond) check((cond), #cond, __func__, __LINE__)
+
+long checks = 0, failures = 0;
+
+void check(bool ok, const char *cond, const char *func, int line)
+{
+    checks++;
+    if (!ok)
+    {
+        failures++;
+        printf("FAIL %s:%d %s\n", func, line, cond);
+    }
+}
+
+/* Helpers
+*********************************************************************/
+// new game w/ given rules and both fleets placed at random, started
+game *newGame(const rules *r, uint64_t seed)
+{
+    game *g = createGame(r);
+
+    if (g == NULL)
+        return NULL;
+    seedGame(g, seed);
+    setStrategy(g, 0, &densityStrategy);
+    setStrategy(g, 1, &huntStrategy);
+    placeRandomFleet(g, 0);
+    placeRandomFleet(g, 1);
+    beginGame(g);
+    return g;
+}
+
+// games have same turn, shots, ships and hit counts
+bool sameGame(game *a, game *b)
+{
+    player *pa, *pb;
+
+    if (a->turn != b->turn || a->running != b->running || a->started != b->started)
+        return false;
+    if (a->rules.width != b->rules.width || a->rules.height != b->rules.height || a->rules.nships != b->rules.nships)
+        return false;
+
+    for (int i = 0; i < 2; i++)
+    {
+        pa = &a->players[i];
+        pb = &b->players[i];
+        if (pa->shotsTaken != pb->shotsTaken || pa->lastShot != pb->lastShot || pa->shipsAfloat != pb->shipsAfloat)
+            return false;
+        if (!bbIsEmpty(bbXor(pa->fleet, pb->fleet)) || !bbIsEmpty(bbXor(pa->hits, pb->hits)) || !bbIsEmpty(bbXor(pa->misses, pb->misses)))
+            return false;
+        for (int y = 1; y <= a->rules.height; y++)
+        {
+            for (int x = 1; x <= a->rules.width; x++)
+            {
+                if (cellState(a, i, x, y) != cellState(b, i, x, y))
+                    return false;
+            }
+        }
+        for (int j = 0; j < pa->nships; j++)
+        {
+            ship *sa = &pa->ships[j], *sb = &pb->ships[j];
+
+            if (sa->x != sb->x || sa->y != sb->y || sa->rot != sb->rot || sa->len != sb->len)
+                return false;
+            if (sa->isPlaced != sb->isPlaced || sa->sunk != sb->sunk || sa->hitCount != sb->hitCount)
+                return false;
+        }
+    }
+    return true;
+}
+
+// both games play computer shots to the end, returns true if every shot and final state match
+bool samePlay(game *a, game *b)
+{
+    while (a->running || b->running)
+    {
+        if (computerShot(a) != computerShot(b))
+            return false;
+    }
+    return sameGame(a, b);
+}
+/********************************************************************/
+
+/* Tests
+*********************************************************************/
+// game restored from a snapshot is in the state it was saved in and plays on the same way
+void testSnapshot(const rules *r)
+{
+    rules relengthed = *r; // same board and fleet size, one ship a different length
+    game *g = newGame(r, 1), *saved = newGame(r, 2), *other = newGame(&standardRules, 3), *fleet;
+    void *snapshot = malloc(snapshotSize(r));
+
+    relengthed.lens[1] = (r->lens[1] == 5) ? 4 : 5;
+    fleet = newGame(&relengthed, 10);
+    CHECK(g != NULL && saved != NULL && other != NULL && fleet != NULL && snapshot != NULL);
+    if (g == NULL || saved == NULL || other == NULL || fleet == NULL || snapshot == NULL)
+        return;
+
+    for (int i = 0; i < SNAPSHOT_SHOTS; i++)
+        computerShot(g);
+    CHECK(snapshotGame(g, snapshot) == 0);
+    CHECK(copyGame(saved, g) == 0);
+
+    while (g->running)
+        computerShot(g);
+    CHECK(!sameGame(g, saved));
+    CHECK(restoreGame(g, snapshot) == 0);
+    CHECK(sameGame(g, saved));
+    CHECK(samePlay(g, saved));
+
+    // snapshots only restore into games w/ same board and fleet
+    if (r->width != standardRules.width || r->height != standardRules.height)
+        CHECK(restoreGame(other, snapshot) == 1);
+    CHECK(restoreGame(fleet, snapshot) == 1);
+
+    free(snapshot);
+    destroyGame(g);
+    destroyGame(saved);
+    destroyGame(other);
+    destroyGame(fleet);
+}
+
+// copies keep their own storage, including copies into games set up for other rules
+void testCopyGame(const rules *r)
+{
+    rules ocean = {200, 200, 5, {5, 4, 3, 3, 2}};
+    game *src = newGame(r, 4), *dst = newGame(&ocean, 5);
+    pool games;
+    game *pooled;
+
+    CHECK(src != NULL && dst != NULL);
+    if (src == NULL || dst == NULL)
+        return;
+
+    // sparse games can't be copied, their cell maps aren't shared
+    CHECK(copyGame(src, dst) == 1);
+
+    for (int i = 0; i < SNAPSHOT_SHOTS; i++)
+        computerShot(src);
+    CHECK(copyGame(dst, src) == 0);
+    CHECK(dst->storage != src->storage);
+    CHECK(dst->players[0].ships != src->players[0].ships);
+    CHECK(sameGame(dst, src));
+    CHECK(samePlay(dst, src));
+
+    // pooled game grows its own storage if src's rules don't fit its slot
+    CHECK(initializeGamePool(&games, 1, NULL) == 0);
+    pooled = acquireGame(&games, NULL);
+    CHECK(pooled != NULL);
+    if (pooled != NULL)
+    {
+        CHECK(copyGame(pooled, src) == 0);
+        CHECK(sameGame(pooled, src));
+        CHECK(initializeGame(pooled, &standardRules) == 0);
+        releaseGame(&games, pooled);
+    }
+    freeGamePool(&games);
+
+    // reused dst plays a sparse game again after holding a copy
+    CHECK(initializeGame(dst, &ocean) == 0);
+    placeRandomFleet(dst, 0);
+    placeRandomFleet(dst, 1);
+    CHECK(beginGame(dst) == 0);
+    while (dst->running)
+        computerShot(dst);
+
+    destroyGame(src);
+    destroyGame(dst);
+}
+
+// shots made w/ makeShot() match fireShot() and taking them back returns to earlier states
+void testMakeShot(const rules *r)
+{
+    game *g = newGame(r, 6), *fired = newGame(r, 7), *start = newGame(r, 8), *middle = newGame(r, 9);
+    int cells = r->width * r->height, mark = -1, cell;
+    undoStack u;
+
+    CHECK(g != NULL && fired != NULL && start != NULL && middle != NULL);
+    CHECK(initializeUndoStack(&u, 2 * cells) == 0);
+    if (g == NULL || fired == NULL || start == NULL || middle == NULL || u.shots == NULL)
+        return;
+
+    for (int i = 0; i < SNAPSHOT_SHOTS; i++)
+        computerShot(g);
+    copyGame(fired, g);
+    copyGame(start, g);
+
+    // each player shoots every cell once in a scattered order, 37 shares no factor w/ board sizes tested
+    while (g->running)
+    {
+        cell = (g->players[g->turn % 2].shotsTaken * 37) % cells;
+        while (cellState(g, (g->turn + 1) % 2, cell % r->width + 1, cell / r->width + 1) >= 2)
+            cell = (cell + 1) % cells;
+        CHECK(makeShot(g, &u, cell % r->width + 1, cell / r->width + 1) == fireShot(fired, cell % r->width + 1, cell / r->width + 1));
+        if (u.count == cells / 2)
+        {
+            mark = u.count;
+            copyGame(middle, g);
+        }
+    }
+    CHECK(sameGame(g, fired));
+    CHECK(makeShot(g, &u, 1, 1) == 0); // game is over
+
+    if (mark >= 0)
+    {
+        rewindGame(g, &u, mark);
+        CHECK(sameGame(g, middle));
+    }
+    rewindGame(g, &u, 0);
+    CHECK(sameGame(g, start));
+    CHECK(unmakeShot(g, &u) == 1);
+    CHECK(samePlay(g, start));
+
+    freeUndoStack(&u);
+    destroyGame(g);
+    destroyGame(fired);
+    destroyGame(start);
+    destroyGame(middle);
+}
+/********************************************************************/
+
+int main(int argc, char *argv[])
+{
+    rules medium = {20, 20, 5, {5, 4, 3, 3, 2}};
+    rules large = {40, 30, 7, {5, 5, 4, 4, 3, 3, 2}};
+    const rules *tested[] = {&standardRules, &medium, &large};
+
+    for (int i = 0; i < sizeof(tested) / sizeof(tested[0]); i++)
+    {
+        testSnapshot(tested[i]);
+        testCopyGame(tested[i]);
+        testMakeShot(tested[i]);
+    }
+
+    printf("%ld checks, %ld failed\n", checks, failures);
+    return failures != 0;
+}
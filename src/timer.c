@@ -0,0 +1,92 @@
+#include "timer.h"
+
+/* Timers
+*********************************************************************/
+// no timers scheduled, speed > 1 runs timers faster than clock
+void initializeScheduler(scheduler *s, double speed)
+{
+    s->now = 0;
+    s->lastClock = -1;
+    s->speed = (speed > 0) ? speed : 1;
+    for (int i = 0; i < MAX_TIMERS; i++)
+        s->timers[i].active = false;
+}
+
+// run action delay seconds of scheduler time from now
+// returns id of timer, -1 if every timer is in use
+int scheduleTimer(scheduler *s, double delay, timerAction action, void *data)
+{
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        if (!s->timers[i].active)
+        {
+            s->timers[i].due = s->now + delay;
+            s->timers[i].action = action;
+            s->timers[i].data = data;
+            s->timers[i].active = true;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void cancelTimer(scheduler *s, int id)
+{
+    if (id >= 0 && id < MAX_TIMERS)
+        s->timers[id].active = false;
+}
+
+// jump scheduler time ahead, timers that become due run on next update
+void skipTime(scheduler *s, double seconds)
+{
+    s->now += seconds;
+}
+
+// advance scheduler time to clock in seconds and run every timer that is due, earliest first
+// actions may schedule more timers, they run in the same update if already due
+// returns number of actions run
+int updateScheduler(scheduler *s, double clock)
+{
+    int next, ran = 0;
+
+    if (s->lastClock >= 0 && clock > s->lastClock)
+        s->now += (clock - s->lastClock) * s->speed;
+    s->lastClock = clock;
+
+    do
+    {
+        next = -1;
+        for (int i = 0; i < MAX_TIMERS; i++)
+        {
+            if (s->timers[i].active && s->timers[i].due <= s->now && (next == -1 || s->timers[i].due < s->timers[next].due))
+                next = i;
+        }
+        if (next != -1)
+        {
+            s->timers[next].active = false; // free timer before action so it can schedule again
+            s->timers[next].action(s->timers[next].data);
+            ran++;
+        }
+    } while (next != -1);
+    return ran;
+}
+
+// clock seconds until next timer is due, 0 if one is overdue, -1 if none are scheduled
+double timeUntilTimer(scheduler *s)
+{
+    double due = 0;
+    bool found = false;
+
+    for (int i = 0; i < MAX_TIMERS; i++)
+    {
+        if (s->timers[i].active && (!found || s->timers[i].due < due))
+        {
+            due = s->timers[i].due;
+            found = true;
+        }
+    }
+    if (!found)
+        return -1;
+    return (due > s->now) ? (due - s->now) / s->speed : 0;
+}
+/********************************************************************/
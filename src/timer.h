@@ -0,0 +1,40 @@
+#ifndef __TIMER_H__
+#define __TIMER_H__
+
+#include <stdbool.h>
+
+#define MAX_TIMERS 8
+
+// called once when timer is due, w/ data given when it was scheduled
+typedef void (*timerAction)(void *data);
+
+typedef struct
+{
+    double due; // scheduler time to run action at
+    timerAction action;
+    void *data;
+    bool active;
+} timer;
+
+// runs actions at set times w/o blocking
+// scheduler time follows the clock passed to updateScheduler(), scaled by speed,
+// so automated runs can fast-forward timed states
+typedef struct
+{
+    double now;       // current scheduler time in seconds
+    double lastClock; // clock at last update, negative before first update
+    double speed;     // scheduler seconds per clock second
+    timer timers[MAX_TIMERS];
+} scheduler;
+
+/* Timers
+*********************************************************************/
+void initializeScheduler(scheduler *s, double speed);
+int scheduleTimer(scheduler *s, double delay, timerAction action, void *data);
+void cancelTimer(scheduler *s, int id);
+void skipTime(scheduler *s, double seconds);
+int updateScheduler(scheduler *s, double clock);
+double timeUntilTimer(scheduler *s);
+/********************************************************************/
+
+#endif
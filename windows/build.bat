@@ -17,13 +17,23 @@ move SDL2_ttf-tmp\x86_64-w64-mingw32 SDL2_ttf
 RMDIR /S /Q SDL2_ttf-tmp
 copy ..\resources\SDL_ttf.h SDL2_ttf\include\SDL2
 
-@REM Compile
+@REM Compile, optimized w/ link time optimization unless built w/ build.bat debug
+set FLAGS=-O3 -flto
+if "%1"=="debug" set FLAGS=-ggdb3 -O0
 mkdir ..\bin ..\obj
 copy SDL2\bin\SDL2.dll ..\bin
 copy SDL2_ttf\bin\*.dll ..\bin
 copy ..\resources\FreeMonoBold.ttf ..\bin
-gcc -Wall -o ..\obj\engine.o -c ..\src\engine.c -ISDL2\include -ISDL2_ttf\include -D_THREAD_SAFE
-gcc -Wall -o ..\obj\rendering.o -c ..\src\rendering.c -ISDL2\include -ISDL2_ttf\include -D_THREAD_SAFE
-gcc -Wall -o ..\bin\battleship ..\src\battleship.c ..\obj\engine.o ..\obj\rendering.o -ISDL2\include -ISDL2_ttf\include -D_THREAD_SAFE -DSDL_MAIN_HANDLED -LSDL2\lib -LSDL2_ttf\lib -lSDL2 -lSDL2_ttf -include stdio.h
+gcc -Wall %FLAGS% -o ..\obj\cellmap.o -c ..\src\cellmap.c
+gcc -Wall %FLAGS% -o ..\obj\pool.o -c ..\src\pool.c
+gcc -Wall %FLAGS% -o ..\obj\rules.o -c ..\src\rules.c
+gcc -Wall %FLAGS% -o ..\obj\engine.o -c ..\src\engine.c
+gcc -Wall %FLAGS% -o ..\obj\opponent.o -c ..\src\opponent.c
+gcc -Wall %FLAGS% -o ..\obj\strategy.o -c ..\src\strategy.c
+gcc -Wall %FLAGS% -o ..\obj\game.o -c ..\src\game.c
+gcc -Wall %FLAGS% -o ..\obj\network.o -c ..\src\network.c
+gcc -Wall %FLAGS% -o ..\obj\timer.o -c ..\src\timer.c
+gcc -Wall %FLAGS% -o ..\obj\rendering.o -c ..\src\rendering.c -ISDL2\include -ISDL2_ttf\include -D_THREAD_SAFE
+gcc -Wall %FLAGS% -o ..\bin\battleship ..\src\battleship.c ..\obj\cellmap.o ..\obj\pool.o ..\obj\rules.o ..\obj\engine.o ..\obj\opponent.o ..\obj\strategy.o ..\obj\game.o ..\obj\network.o ..\obj\timer.o ..\obj\rendering.o -ISDL2\include -ISDL2_ttf\include -D_THREAD_SAFE -DSDL_MAIN_HANDLED -LSDL2\lib -LSDL2_ttf\lib -lSDL2 -lSDL2_ttf -lws2_32 -include stdio.h
 
 pause
\ No newline at end of file